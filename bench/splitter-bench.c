@@ -0,0 +1,455 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmarks LrSplitter on the regexes of every language preset.
+ *
+ * Each preset splits a generated corpus, and the bundled corpus of its
+ * language if there is one, at several sizes. The splitting itself and
+ * the word, offset, range and context lookups are timed, and reported
+ * with the peak memory of the process.
+ *
+ * The corpora are also split by LrStreamSplitter, reading them from a
+ * SQLite blob in chunks, and its words and sentences are checked against
+ * the ones of LrSplitter. Any difference makes the benchmark fail.
+ *
+ * Usage: splitter-bench [CORPUS_DIR] [SIZE_KIB...]
+ *
+ * The bundled corpora are the files CORPUS_DIR/<language code>.txt.
+ */
+
+#include "language_presets.h"
+#include "lr-blob-input-stream.h"
+#include "lr-char-class.h"
+#include "lr-splitter.h"
+#include "lr-stream-splitter.h"
+#include <sqlite3.h>
+#include <string.h>
+#include <sys/resource.h>
+
+static const gsize default_sizes[] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+
+/* How many random lookups of each kind are timed */
+#define N_LOOKUPS 100000
+#define N_CONTEXTS 10000
+
+/* The code points of the class, from which the generated words are made */
+static GArray *
+class_members (const gchar *regex)
+{
+  GArray *members = g_array_new (FALSE, FALSE, sizeof (gunichar));
+  lr_char_class_t *klass = lr_char_class_new_from_regex (regex);
+  g_assert (klass != NULL);
+
+  for (gunichar c = 0; c < klass->n_blocks * 256; c++)
+    {
+      if (lr_char_class_contains (klass, c))
+        g_array_append_val (members, c);
+    }
+
+  lr_char_class_free (klass);
+  return members;
+}
+
+/* Generates about size bytes of sentences of words of the preset's class.
+ * Most letters are ASCII, as in the texts most people read. */
+static gchar *
+generate_corpus (const lr_language_preset_t *preset, gsize size)
+{
+  GArray *members = class_members (preset->regex);
+  gchar **abbreviations = g_strsplit (preset->abbreviations, " ", -1);
+  guint n_abbreviations = g_strv_length (abbreviations);
+
+  GRand *rand = g_rand_new_with_seed (42);
+  GString *corpus = g_string_sized_new (size + 64);
+
+  int words_left = 0;
+  while (corpus->len < size)
+    {
+      if (words_left == 0)
+        words_left = g_rand_int_range (rand, 4, 25);
+
+      if (n_abbreviations > 0 && g_rand_int_range (rand, 0, 40) == 0)
+        {
+          g_string_append (corpus, abbreviations[g_rand_int_range (rand, 0, n_abbreviations)]);
+        }
+      else
+        {
+          int length = g_rand_int_range (rand, 1, 12);
+          for (int i = 0; i < length; i++)
+            {
+              if (g_rand_int_range (rand, 0, 12) == 0)
+                {
+                  int member = g_rand_int_range (rand, 0, members->len);
+                  g_string_append_unichar (corpus, g_array_index (members, gunichar, member));
+                }
+              else
+                {
+                  g_string_append_c (corpus, 'a' + g_rand_int_range (rand, 0, 26));
+                }
+            }
+        }
+
+      if (--words_left > 0)
+        g_string_append (corpus, g_rand_int_range (rand, 0, 10) == 0 ? ", " : " ");
+      else
+        g_string_append (corpus, g_rand_int_range (rand, 0, 8) == 0 ? ".\n\n" : ". ");
+    }
+
+  g_rand_free (rand);
+  g_strfreev (abbreviations);
+  g_array_free (members, TRUE);
+
+  return g_string_free (corpus, FALSE);
+}
+
+/* Repeats the corpus up to about size bytes, or returns NULL if there is none */
+static gchar *
+load_corpus (const gchar *dir, const gchar *code, gsize size)
+{
+  if (dir == NULL)
+    return NULL;
+
+  gchar *filename = g_strdup_printf ("%s.txt", code);
+  gchar *path = g_build_filename (dir, filename, NULL);
+  g_free (filename);
+
+  gchar *contents;
+  gsize length;
+  gboolean found = g_file_get_contents (path, &contents, &length, NULL);
+  g_free (path);
+
+  if (!found || length == 0)
+    return NULL;
+
+  GString *corpus = g_string_sized_new (size + length);
+  while (corpus->len < size)
+    {
+      g_string_append_len (corpus, contents, length);
+      g_string_append_c (corpus, '\n');
+    }
+  g_free (contents);
+
+  return g_string_free (corpus, FALSE);
+}
+
+static glong
+peak_memory_kib (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static void
+report (const gchar *what, gdouble seconds, gsize bytes, gsize items, const gchar *unit)
+{
+  if (bytes > 0)
+    g_print ("  %-10s %9.2f ms %10.1f MB/s %14.0f %s/s\n",
+             what,
+             seconds * 1000,
+             bytes / seconds / 1e6,
+             items / seconds,
+             unit);
+  else
+    g_print (
+      "  %-10s %9.2f ms %15s %14.0f %s/s\n", what, seconds * 1000, "", items / seconds, unit);
+}
+
+typedef struct
+{
+  GArray *words;
+  GArray *sentences;
+} stream_ranges_t;
+
+static void
+collect_word (const lr_range_t *range, gpointer user_data)
+{
+  g_array_append_vals (((stream_ranges_t *)user_data)->words, range, 1);
+}
+
+static void
+collect_sentence (const lr_range_t *range, gpointer user_data)
+{
+  g_array_append_vals (((stream_ranges_t *)user_data)->sentences, range, 1);
+}
+
+/* Opens a stream over the corpus stored in an in-memory database, as the
+ * texts are read from the Texts table */
+static GInputStream *
+open_corpus_stream (sqlite3 *db, const gchar *corpus)
+{
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_exec (db, "DELETE FROM Texts;", NULL, NULL, NULL) == SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (db, "INSERT INTO Texts (Text) VALUES (?1);", -1, &stmt, NULL) ==
+            SQLITE_OK);
+  sqlite3_bind_text (stmt, 1, corpus, -1, SQLITE_STATIC);
+  g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+  sqlite3_finalize (stmt);
+
+  sqlite3_blob *blob;
+  sqlite3_int64 row = sqlite3_last_insert_rowid (db);
+  g_assert (sqlite3_blob_open (db, "main", "Texts", "Text", row, 0, &blob) == SQLITE_OK);
+
+  return lr_blob_input_stream_new (blob);
+}
+
+static gboolean
+same_ranges (const gchar *what, GArray *streamed, GArray *expected)
+{
+  for (guint i = 0; i < MIN (streamed->len, expected->len); i++)
+    {
+      lr_range_t *a = &g_array_index (streamed, lr_range_t, i);
+      lr_range_t *b = &g_array_index (expected, lr_range_t, i);
+      if (a->start != b->start || a->end != b->end)
+        {
+          g_printerr ("  MISMATCH: %s %u is [%d, %d) when streamed, [%d, %d) otherwise\n",
+                      what,
+                      i,
+                      a->start,
+                      a->end,
+                      b->start,
+                      b->end);
+          return FALSE;
+        }
+    }
+
+  if (streamed->len != expected->len)
+    {
+      g_printerr ("  MISMATCH: %u %ss when streamed, %u otherwise\n",
+                  streamed->len,
+                  what,
+                  expected->len);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Splits the corpus with the streaming splitter, and compares its ranges
+ * with the ones of the splitter */
+static gboolean
+check_stream_splitter (LrLanguage *language, sqlite3 *db, const gchar *corpus, LrSplitter *splitter)
+{
+  stream_ranges_t ranges;
+  ranges.words = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+  ranges.sentences = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+
+  GInputStream *stream = open_corpus_stream (db, corpus);
+  LrStreamSplitter *stream_splitter = lr_stream_splitter_new (language);
+
+  GError *error = NULL;
+  GTimer *timer = g_timer_new ();
+  gboolean success = lr_stream_splitter_split (
+    stream_splitter, stream, collect_word, collect_sentence, &ranges, NULL, &error);
+  report ("stream", g_timer_elapsed (timer, NULL), strlen (corpus), ranges.words->len, "tokens");
+  g_timer_destroy (timer);
+
+  if (!success)
+    {
+      g_printerr ("  Streaming failed: %s\n", error->message);
+      g_error_free (error);
+    }
+
+  GArray *words = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+  for (int i = 0; i < lr_splitter_get_n_words (splitter); i++)
+    {
+      lr_range_t range;
+      lr_splitter_get_word (splitter, i, &range);
+      g_array_append_val (words, range);
+    }
+
+  /* The streaming splitter doesn't report an empty last sentence */
+  GArray *sentences = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+  for (int i = 0; i < lr_splitter_get_n_sentences (splitter); i++)
+    {
+      lr_range_t range;
+      lr_splitter_get_sentence (splitter, i, &range);
+      if (range.end > range.start || i + 1 < lr_splitter_get_n_sentences (splitter))
+        g_array_append_val (sentences, range);
+    }
+
+  success = success && same_ranges ("word", ranges.words, words) &&
+            same_ranges ("sentence", ranges.sentences, sentences);
+
+  g_array_free (words, TRUE);
+  g_array_free (sentences, TRUE);
+  g_array_free (ranges.words, TRUE);
+  g_array_free (ranges.sentences, TRUE);
+  g_object_unref (stream_splitter);
+  g_object_unref (stream);
+
+  return success;
+}
+
+static gboolean
+run_benchmark (LrLanguage *language, sqlite3 *db, const gchar *corpus_name, const gchar *corpus)
+{
+  gsize length = strlen (corpus);
+
+  LrText *text = lr_text_new (-1, language, corpus_name, "");
+  lr_text_set_text (text, corpus);
+
+  g_print ("%s, %s corpus, %" G_GSIZE_FORMAT " KiB\n",
+           lr_language_get_name (language),
+           corpus_name,
+           length / 1024);
+
+  /* Splitting */
+  GTimer *timer = g_timer_new ();
+  LrSplitter *splitter = lr_splitter_new (text);
+  gdouble elapsed = g_timer_elapsed (timer, NULL);
+
+  int n_words = lr_splitter_get_n_words (splitter);
+  report ("split", elapsed, length, n_words, "tokens");
+
+  gboolean success = check_stream_splitter (language, db, corpus, splitter);
+
+  /* Walking all the words */
+  gsize checksum = 0;
+  g_timer_start (timer);
+  for (int i = 0; i < n_words; i++)
+    {
+      lr_range_t range, chars;
+      lr_splitter_get_word (splitter, i, &range);
+      lr_splitter_get_word_chars (splitter, i, &chars);
+      checksum += range.end - range.start + chars.end - chars.start;
+    }
+  report ("words", g_timer_elapsed (timer, NULL), length, n_words, "tokens");
+
+  if (n_words == 0)
+    goto done;
+
+  /* Finding the words at random offsets, as clicking does */
+  GRand *rand = g_rand_new_with_seed (7);
+  g_timer_start (timer);
+  for (int i = 0; i < N_LOOKUPS; i++)
+    checksum += lr_splitter_get_word_index_at_offset (splitter, g_rand_int_range (rand, 0, length));
+  report ("offsets", g_timer_elapsed (timer, NULL), 0, N_LOOKUPS, "lookups");
+
+  /* Selections of a few consecutive words */
+  GPtrArray *selections = g_ptr_array_new_with_free_func ((GDestroyNotify)g_array_unref);
+  for (int i = 0; i < N_CONTEXTS; i++)
+    {
+      GArray *selection = g_array_new (FALSE, FALSE, sizeof (int));
+      int first = g_rand_int_range (rand, 0, n_words);
+      int n_selected = MIN (g_rand_int_range (rand, 1, 4), n_words - first);
+      for (int j = 0; j < n_selected; j++)
+        {
+          int word = first + j;
+          g_array_append_val (selection, word);
+        }
+      g_ptr_array_add (selections, selection);
+    }
+  g_rand_free (rand);
+
+  g_timer_start (timer);
+  for (guint i = 0; i < selections->len; i++)
+    {
+      GArray *ranges = lr_splitter_selection_to_ranges (splitter, selections->pdata[i]);
+      checksum += ranges->len;
+      g_array_unref (ranges);
+    }
+  report ("ranges", g_timer_elapsed (timer, NULL), 0, selections->len, "selections");
+
+  g_timer_start (timer);
+  for (guint i = 0; i < selections->len; i++)
+    {
+      gchar *context, *answer;
+      lr_splitter_context_from_selection (splitter, selections->pdata[i], &context, &answer, "___");
+      checksum += strlen (context);
+      g_free (context);
+      g_free (answer);
+    }
+  report ("contexts", g_timer_elapsed (timer, NULL), 0, selections->len, "selections");
+
+  g_ptr_array_unref (selections);
+
+done:
+  g_print ("  splitter %" G_GSIZE_FORMAT " KiB, peak RSS %ld KiB (checksum %" G_GSIZE_FORMAT
+           ")\n\n",
+           lr_splitter_get_memory_size (splitter) / 1024,
+           peak_memory_kib (),
+           checksum);
+
+  g_timer_destroy (timer);
+  g_object_unref (splitter);
+  g_object_unref (text);
+
+  return success;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const gchar *corpus_dir = argc > 1 ? argv[1] : NULL;
+
+  GArray *sizes = g_array_new (FALSE, FALSE, sizeof (gsize));
+  for (int i = 2; i < argc; i++)
+    {
+      gsize size = g_ascii_strtoull (argv[i], NULL, 10) * 1024;
+      if (size == 0)
+        {
+          g_printerr ("Invalid size '%s'\n", argv[i]);
+          return 1;
+        }
+      g_array_append_val (sizes, size);
+    }
+  if (sizes->len == 0)
+    g_array_append_vals (sizes, default_sizes, G_N_ELEMENTS (default_sizes));
+
+  /* Where the streaming splitter reads the corpora from */
+  sqlite3 *db;
+  g_assert (sqlite3_open (":memory:", &db) == SQLITE_OK);
+  g_assert (sqlite3_exec (db, "CREATE TABLE Texts (Text TEXT);", NULL, NULL, NULL) == SQLITE_OK);
+
+  gboolean success = TRUE;
+
+  for (guint i = 0; i < G_N_ELEMENTS (presets); i++)
+    {
+      const lr_language_preset_t *preset = &presets[i];
+
+      /* Each preset is a language of its own in the regex cache */
+      LrLanguage *language =
+        lr_language_new (i + 1, preset->code, preset->name, preset->regex, preset->separator_regex);
+      lr_language_set_abbreviations (language, preset->abbreviations);
+
+      for (guint j = 0; j < sizes->len; j++)
+        {
+          gsize size = g_array_index (sizes, gsize, j);
+
+          gchar *corpus = generate_corpus (preset, size);
+          success &= run_benchmark (language, db, "generated", corpus);
+          g_free (corpus);
+
+          corpus = load_corpus (corpus_dir, preset->code, size);
+          if (corpus)
+            {
+              success &= run_benchmark (language, db, "bundled", corpus);
+              g_free (corpus);
+            }
+        }
+
+      g_object_unref (language);
+    }
+
+  g_array_free (sizes, TRUE);
+  sqlite3_close (db);
+
+  return success ? 0 : 1;
+}
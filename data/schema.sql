@@ -4,8 +4,9 @@ CREATE TABLE IF NOT EXISTS "Instances" (
 	"ID"	INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,
 	"LemmaID"	INTEGER NOT NULL,
 	"TextID"	INTEGER NOT NULL,
-	"Words"	TEXT NOT NULL,
+	"Words"	BLOB NOT NULL,
 	"Note"	TEXT NOT NULL,
+	"Stale"	INTEGER NOT NULL DEFAULT 0,
 	FOREIGN KEY("TextID") REFERENCES "Texts"("ID") ON DELETE CASCADE,
 	FOREIGN KEY("LemmaID") REFERENCES "Lemmas"("ID") ON DELETE CASCADE
 );
@@ -15,7 +16,10 @@ CREATE TABLE IF NOT EXISTS "Languages" (
 	"Code"	TEXT NOT NULL UNIQUE,
 	"Name"	TEXT NOT NULL UNIQUE,
 	"WordRegex"	TEXT DEFAULT '[a-zA-Z]+',
-	"SeparatorRegex" TEXT DEFAULT '. '
+	"SeparatorRegex" TEXT DEFAULT '. ',
+	"Abbreviations"	TEXT NOT NULL DEFAULT '',
+	"SegmenterVersion"	INTEGER NOT NULL DEFAULT 0,
+	"SegmenterWords"	BLOB
 );
 DROP TABLE IF EXISTS "Texts";
 CREATE TABLE IF NOT EXISTS "Texts" (
@@ -35,4 +39,13 @@ CREATE TABLE IF NOT EXISTS "Lemmas" (
 	FOREIGN KEY("LanguageID") REFERENCES "Languages"("ID") ON DELETE CASCADE,
 	UNIQUE("Lemma","LanguageID")
 );
+DROP TABLE IF EXISTS "Tokenizations";
+CREATE TABLE IF NOT EXISTS "Tokenizations" (
+	"TextID"	INTEGER NOT NULL PRIMARY KEY,
+	"RegexHash"	INTEGER NOT NULL,
+	"Words"	BLOB NOT NULL,
+	"Separators"	BLOB NOT NULL,
+	FOREIGN KEY("TextID") REFERENCES "Texts"("ID") ON DELETE CASCADE
+);
+PRAGMA user_version = 7;
 COMMIT;
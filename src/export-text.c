@@ -18,6 +18,7 @@
 
 #include "export-text.h"
 #include "lr-splitter.h"
+#include "lr-splitter-cache.h"
 
 char *
 get_filename (GtkWindow *toplevel, const gchar *filter_name, const gchar *filter)
@@ -87,53 +88,64 @@ lr_export_text (GtkWidget *toplevel,
   g_output_stream_write (
     G_OUTPUT_STREAM (ostream), preamble, g_utf8_strlen (preamble, -1), NULL, NULL);
 
-  LrText *text = NULL;
-  LrSplitter *splitter = NULL;
+  GPtrArray *selections = g_ptr_array_new_with_free_func ((GDestroyNotify)g_array_unref);
+  GArray *clozes = g_array_new (FALSE, FALSE, sizeof (lr_cloze_t));
+  GString *buffer = g_string_new (NULL);
+  GString *line_str = g_string_new (NULL);
 
-  for (GList *l = items; l != NULL; l = l->next)
+  GList *l = items;
+  while (l != NULL)
     {
-      lr_vocabulary_item_t *item = (lr_vocabulary_item_t *)l->data;
-      if (text != item->text)
-        {
-          /* Load the text and split it */
-          g_clear_object (&splitter); /* Destroy the old one */
-          g_clear_object (&text);
-
-          text = item->text;
-          lr_database_load_text (db, text);
+      /* Load the text of the next run of items and split it */
+      LrText *text = ((lr_vocabulary_item_t *)l->data)->text;
+      lr_database_load_text (db, text);
+      LrSplitter *splitter = lr_splitter_cache_lookup (text, db);
 
-          splitter = lr_splitter_new (text);
+      GList *first = l;
+      for (; l != NULL && ((lr_vocabulary_item_t *)l->data)->text == text; l = l->next)
+        {
+          lr_vocabulary_item_t *item = (lr_vocabulary_item_t *)l->data;
+          g_ptr_array_add (selections, lr_splitter_words_from_bytes (splitter, item->words));
         }
 
-      GList *selection = lr_splitter_ranges_from_string (splitter, item->words);
-
-      gchar *context, *answer;
-      lr_splitter_context_from_selection (splitter, &selection, &context, &answer, "______");
+      /* Generate the clozes of all items of the text at once */
+      g_string_truncate (buffer, 0);
+      lr_splitter_clozes_from_selections (splitter, selections, "______", buffer, clozes);
 
-      GString *line_str = g_string_new (prefix);
-      g_string_append (line_str, context);
-      g_string_append (line_str, field_sep);
-      g_string_append (line_str, answer);
-      g_string_append (line_str, field_sep);
-      g_string_append (line_str, item->lemma);
-      g_string_append (line_str, field_sep);
-      g_string_append (line_str, item->translation);
-      g_string_append (line_str, field_sep);
-      g_string_append (line_str, item->note);
-      g_string_append (line_str, postfix);
-
-      /* Write the line to the stream */
-      g_output_stream_write (G_OUTPUT_STREAM (ostream), line_str->str, line_str->len, NULL, NULL);
-
-      g_string_free (line_str, TRUE);
+      guint i = 0;
+      for (GList *m = first; m != l; m = m->next, i++)
+        {
+          lr_vocabulary_item_t *item = (lr_vocabulary_item_t *)m->data;
+          const lr_cloze_t *cloze = &g_array_index (clozes, lr_cloze_t, i);
+
+          g_string_assign (line_str, prefix);
+          g_string_append_len (line_str, buffer->str + cloze->context_offset, cloze->context_length);
+          g_string_append (line_str, field_sep);
+          g_string_append_len (line_str, buffer->str + cloze->answer_offset, cloze->answer_length);
+          g_string_append (line_str, field_sep);
+          g_string_append (line_str, item->lemma);
+          g_string_append (line_str, field_sep);
+          g_string_append (line_str, item->translation);
+          g_string_append (line_str, field_sep);
+          g_string_append (line_str, item->note);
+          g_string_append (line_str, postfix);
+
+          /* Write the line to the stream */
+          g_output_stream_write (
+            G_OUTPUT_STREAM (ostream), line_str->str, line_str->len, NULL, NULL);
+        }
 
-      g_free (context);
-      g_free (answer);
+      g_ptr_array_set_size (selections, 0);
+      g_object_unref (splitter);
 
-      g_list_free (selection);
+      /* The items hold the reference the vocabulary view took on their text */
+      g_object_unref (text);
     }
 
-  g_clear_object (&splitter);
+  g_string_free (line_str, TRUE);
+  g_string_free (buffer, TRUE);
+  g_array_free (clozes, TRUE);
+  g_ptr_array_free (selections, TRUE);
 
   g_output_stream_write (
     G_OUTPUT_STREAM (ostream), postamble, g_utf8_strlen (postamble, -1), NULL, NULL);
@@ -0,0 +1,147 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Generates lr-preset-classes.c, which holds the two-level bitmaps of the
+ * word classes of the language presets, so that they need not be parsed
+ * from their regexes at runtime.
+ *
+ * Usage: gen-preset-classes OUTPUT
+ */
+
+#include "language_presets.h"
+#include "lr-char-class.h"
+#include <stdio.h>
+
+/* Writes the string as a C literal, escaping everything but printable ASCII */
+static void
+write_string (FILE *file, const gchar *string)
+{
+  fputc ('"', file);
+  for (const guchar *p = (const guchar *)string; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+        fprintf (file, "\\%c", *p);
+      else if (*p >= 0x20 && *p < 0x7F)
+        fputc (*p, file);
+      else
+        fprintf (file, "\\%03o", *p);
+    }
+  fputc ('"', file);
+}
+
+/* The separator before the i'th of the items printed per_line to a line */
+static const gchar *
+separator (guint i, guint per_line)
+{
+  if (i == 0)
+    return "\n  ";
+  return (i % per_line) ? ", " : ",\n  ";
+}
+
+static void
+write_class (FILE *file, int preset, const lr_char_class_t *klass)
+{
+  guint n_bitmaps = 0;
+  for (guint block = 0; block < klass->n_blocks; block++)
+    n_bitmaps = MAX (n_bitmaps, klass->index[block] + 1u);
+
+  fprintf (file, "/* %s */\n", presets[preset].name);
+  fprintf (file, "static const guint16 index_%d[] = {", preset);
+  for (guint block = 0; block < klass->n_blocks; block++)
+    fprintf (file, "%s%u", separator (block, 16), klass->index[block]);
+  fprintf (file, "\n};\n\n");
+
+  fprintf (file, "static const guint32 bitmaps_%d[] = {", preset);
+  for (guint i = 0; i < n_bitmaps * 8; i++)
+    fprintf (file, "%s0x%08x", separator (i, 8), klass->bitmaps[i]);
+  fprintf (file, "\n};\n\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc != 2)
+    {
+      fprintf (stderr, "Usage: %s OUTPUT\n", argv[0]);
+      return 1;
+    }
+
+  FILE *file = fopen (argv[1], "w");
+  if (!file)
+    {
+      perror (argv[1]);
+      return 1;
+    }
+
+  int n_presets = G_N_ELEMENTS (presets);
+  lr_char_class_t **classes = g_new (lr_char_class_t *, n_presets);
+
+  fprintf (file, "/* Generated by gen-preset-classes from language_presets.h. Do not edit. */\n\n");
+  fprintf (file, "#include \"lr-preset-classes.h\"\n\n");
+
+  for (int i = 0; i < n_presets; i++)
+    {
+      classes[i] = lr_char_class_new_from_regex (presets[i].regex);
+      if (!classes[i])
+        {
+          fprintf (stderr, "The word regex of the %s preset is not a class\n", presets[i].name);
+          fclose (file);
+          return 1;
+        }
+
+      write_class (file, i, classes[i]);
+    }
+
+  fprintf (file, "static const struct\n{\n  const gchar *regex;\n  lr_char_class_t klass;\n}");
+  fprintf (file, " preset_classes[] = {\n");
+  for (int i = 0; i < n_presets; i++)
+    {
+      fprintf (file, "  { ");
+      write_string (file, presets[i].regex);
+      fprintf (file,
+               ",\n    { %u, (guint16 *)index_%d, (guint32 *)bitmaps_%d } },\n",
+               classes[i]->n_blocks,
+               i,
+               i);
+      lr_char_class_free (classes[i]);
+    }
+  fprintf (file, "};\n\n");
+  g_free (classes);
+
+  fprintf (file,
+           "const lr_char_class_t *\n"
+           "lr_preset_class_lookup (const gchar *regex)\n"
+           "{\n"
+           "  for (guint i = 0; i < G_N_ELEMENTS (preset_classes); i++)\n"
+           "    {\n"
+           "      if (g_strcmp0 (preset_classes[i].regex, regex) == 0)\n"
+           "        return &preset_classes[i].klass;\n"
+           "    }\n"
+           "\n"
+           "  return NULL;\n"
+           "}\n");
+
+  if (fclose (file) != 0)
+    {
+      perror (argv[1]);
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-ascii-set.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_DISPATCH 1
+#endif
+
+static guint32
+classify_portable (const lr_ascii_set_t *set, const guchar *p, guint32 *non_ascii)
+{
+  guint32 members = 0, high = 0;
+  for (guint i = 0; i < LR_ASCII_BLOCK_SIZE; i++)
+    {
+      guchar c = p[i];
+      if (c >= 0x80)
+        high |= 1u << i;
+      else if ((set->bitmap[c >> 5] >> (c & 31)) & 1)
+        members |= 1u << i;
+    }
+
+  *non_ascii = high;
+  return members;
+}
+
+/*
+ * A byte c is in the range [first, first + span] exactly when the unsigned
+ * saturating subtraction (c - first) - span is zero. Bytes of 0x80 and
+ * above are never in a range since the ranges are all ASCII.
+ */
+
+#if defined(__SSE2__)
+static guint32
+classify_sse2 (const lr_ascii_set_t *set, const guchar *p, guint32 *non_ascii)
+{
+  guint32 members = 0, high = 0;
+  for (guint half = 0; half < 2; half++)
+    {
+      __m128i bytes = _mm_loadu_si128 ((const __m128i *)(p + half * 16));
+      __m128i member = _mm_setzero_si128 ();
+
+      for (guint i = 0; i < set->n_ranges; i++)
+        {
+          __m128i offset = _mm_sub_epi8 (bytes, _mm_set1_epi8 ((char)set->first[i]));
+          __m128i outside = _mm_subs_epu8 (offset, _mm_set1_epi8 ((char)set->span[i]));
+          member = _mm_or_si128 (member, _mm_cmpeq_epi8 (outside, _mm_setzero_si128 ()));
+        }
+
+      members |= (guint32)_mm_movemask_epi8 (member) << (half * 16);
+      high |= (guint32)_mm_movemask_epi8 (bytes) << (half * 16);
+    }
+
+  *non_ascii = high;
+  return members & ~high;
+}
+#endif
+
+#if defined(HAVE_X86_DISPATCH)
+__attribute__ ((target ("avx2"))) static guint32
+classify_avx2 (const lr_ascii_set_t *set, const guchar *p, guint32 *non_ascii)
+{
+  __m256i bytes = _mm256_loadu_si256 ((const __m256i *)p);
+  __m256i member = _mm256_setzero_si256 ();
+
+  for (guint i = 0; i < set->n_ranges; i++)
+    {
+      __m256i offset = _mm256_sub_epi8 (bytes, _mm256_set1_epi8 ((char)set->first[i]));
+      __m256i outside = _mm256_subs_epu8 (offset, _mm256_set1_epi8 ((char)set->span[i]));
+      member = _mm256_or_si256 (member, _mm256_cmpeq_epi8 (outside, _mm256_setzero_si256 ()));
+    }
+
+  guint32 high = (guint32)_mm256_movemask_epi8 (bytes);
+  *non_ascii = high;
+  return (guint32)_mm256_movemask_epi8 (member) & ~high;
+}
+#endif
+
+/* The fastest implementation for the ranges on this CPU */
+static lr_ascii_classify_func_t
+pick_classify_func (void)
+{
+#if defined(HAVE_X86_DISPATCH)
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    return classify_avx2;
+#endif
+#if defined(__SSE2__)
+  return classify_sse2;
+#else
+  return classify_portable;
+#endif
+}
+
+void
+lr_ascii_set_init (lr_ascii_set_t *set, const guint32 bitmap[4])
+{
+  static gsize best_classify = 0;
+  if (g_once_init_enter (&best_classify))
+    g_once_init_leave (&best_classify, (gsize)pick_classify_func ());
+
+  for (guint i = 0; i < 4; i++)
+    set->bitmap[i] = bitmap[i];
+
+  /* Collect the runs of consecutive characters */
+  set->n_ranges = 0;
+  guint c = 0;
+  while (c < 128)
+    {
+      if (!((bitmap[c >> 5] >> (c & 31)) & 1))
+        {
+          c++;
+          continue;
+        }
+
+      guint first = c;
+      while (c < 128 && ((bitmap[c >> 5] >> (c & 31)) & 1))
+        c++;
+
+      if (set->n_ranges == LR_ASCII_SET_MAX_RANGES)
+        {
+          set->classify = classify_portable;
+          set->vectorized = FALSE;
+          return;
+        }
+
+      set->first[set->n_ranges] = first;
+      set->span[set->n_ranges] = c - 1 - first;
+      set->n_ranges++;
+    }
+
+  set->classify = (lr_ascii_classify_func_t)best_classify;
+  set->vectorized = set->classify != classify_portable;
+}
+
+void
+lr_ascii_set_init_from_chars (lr_ascii_set_t *set, const gchar *chars)
+{
+  guint32 bitmap[4] = { 0, 0, 0, 0 };
+  for (const guchar *p = (const guchar *)chars; *p; p++)
+    {
+      g_assert (*p < 0x80);
+      bitmap[*p >> 5] |= 1u << (*p & 31);
+    }
+
+  lr_ascii_set_init (set, bitmap);
+}
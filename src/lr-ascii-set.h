@@ -0,0 +1,85 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_ascii_set_h
+#define _lr_ascii_set_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A set of ASCII characters that classifies a whole block of bytes at a
+ * time, with SSE2 or AVX2 where available. The set is stored as up to
+ * LR_ASCII_SET_MAX_RANGES ranges of bytes, which is what the vector code
+ * compares against; larger sets are classified byte by byte.
+ */
+
+#define LR_ASCII_BLOCK_SIZE 32
+#define LR_ASCII_SET_MAX_RANGES 8
+
+typedef struct _lr_ascii_set_t lr_ascii_set_t;
+
+typedef guint32 (*lr_ascii_classify_func_t) (const lr_ascii_set_t *set,
+                                             const guchar *p,
+                                             guint32 *non_ascii);
+
+struct _lr_ascii_set_t
+{
+  guint32 bitmap[4];
+
+  guint n_ranges;
+  guchar first[LR_ASCII_SET_MAX_RANGES];
+  guchar span[LR_ASCII_SET_MAX_RANGES];
+
+  lr_ascii_classify_func_t classify;
+
+  /* Whether classify uses vector instructions. Byte by byte, classifying
+   * whole blocks is no faster than looking at the bytes as needed. */
+  gboolean vectorized;
+};
+
+/* Initializes the set from a bitmap of the 128 ASCII characters */
+void lr_ascii_set_init (lr_ascii_set_t *set, const guint32 bitmap[4]);
+
+/* Initializes the set from a string of ASCII characters */
+void lr_ascii_set_init_from_chars (lr_ascii_set_t *set, const gchar *chars);
+
+/* Classifies the LR_ASCII_BLOCK_SIZE bytes at p. Bit i of the result is set
+ * if p[i] is in the set, and bit i of non_ascii if p[i] is 0x80 or above.
+ */
+static inline guint32
+lr_ascii_set_classify (const lr_ascii_set_t *set, const guchar *p, guint32 *non_ascii)
+{
+  return set->classify (set, p, non_ascii);
+}
+
+/* The index of the lowest set bit, which has to exist */
+static inline guint
+lr_lowest_bit (guint32 bits)
+{
+#if defined(__GNUC__)
+  return __builtin_ctz (bits);
+#else
+  return g_bit_nth_lsf (bits, -1);
+#endif
+}
+
+G_END_DECLS
+
+#endif /* _lr_ascii_set_h */
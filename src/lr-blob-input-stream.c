@@ -0,0 +1,104 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-blob-input-stream.h"
+
+struct _LrBlobInputStream
+{
+  GInputStream parent_instance;
+
+  sqlite3_blob *blob;
+  int offset;
+};
+
+G_DEFINE_TYPE (LrBlobInputStream, lr_blob_input_stream, G_TYPE_INPUT_STREAM)
+
+static void
+lr_blob_input_stream_init (LrBlobInputStream *self)
+{
+  self->blob = NULL;
+  self->offset = 0;
+}
+
+static gssize
+lr_blob_input_stream_read (GInputStream *stream,
+                           void *buffer,
+                           gsize count,
+                           GCancellable *cancellable,
+                           GError **error)
+{
+  LrBlobInputStream *self = LR_BLOB_INPUT_STREAM (stream);
+
+  int remaining = sqlite3_blob_bytes (self->blob) - self->offset;
+  int n_bytes = MIN (count, (gsize)remaining);
+  if (n_bytes <= 0)
+    return 0;
+
+  int rc = sqlite3_blob_read (self->blob, buffer, n_bytes, self->offset);
+  if (rc != SQLITE_OK)
+    {
+      g_set_error (
+        error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to read blob: '%s'", sqlite3_errstr (rc));
+      return -1;
+    }
+
+  self->offset += n_bytes;
+  return n_bytes;
+}
+
+static gboolean
+lr_blob_input_stream_close (GInputStream *stream, GCancellable *cancellable, GError **error)
+{
+  LrBlobInputStream *self = LR_BLOB_INPUT_STREAM (stream);
+
+  g_clear_pointer (&self->blob, sqlite3_blob_close);
+
+  return TRUE;
+}
+
+static void
+lr_blob_input_stream_finalize (GObject *object)
+{
+  LrBlobInputStream *self = LR_BLOB_INPUT_STREAM (object);
+
+  g_clear_pointer (&self->blob, sqlite3_blob_close);
+
+  G_OBJECT_CLASS (lr_blob_input_stream_parent_class)->finalize (object);
+}
+
+static void
+lr_blob_input_stream_class_init (LrBlobInputStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->finalize = lr_blob_input_stream_finalize;
+
+  GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+  stream_class->read_fn = lr_blob_input_stream_read;
+  stream_class->close_fn = lr_blob_input_stream_close;
+}
+
+GInputStream *
+lr_blob_input_stream_new (sqlite3_blob *blob)
+{
+  g_assert (blob != NULL);
+
+  LrBlobInputStream *self = g_object_new (LR_TYPE_BLOB_INPUT_STREAM, NULL);
+  self->blob = blob;
+
+  return G_INPUT_STREAM (self);
+}
@@ -0,0 +1,38 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_blob_input_stream_h
+#define _lr_blob_input_stream_h
+
+#include <gio/gio.h>
+#include <sqlite3.h>
+
+G_BEGIN_DECLS
+
+#define LR_TYPE_BLOB_INPUT_STREAM (lr_blob_input_stream_get_type ())
+G_DECLARE_FINAL_TYPE (
+  LrBlobInputStream, lr_blob_input_stream, LR, BLOB_INPUT_STREAM, GInputStream)
+
+/* Creates a stream reading the given blob incrementally. The stream takes
+ * ownership of the blob and closes it when it is closed or finalized.
+ */
+GInputStream *lr_blob_input_stream_new (sqlite3_blob *blob);
+
+G_END_DECLS
+
+#endif /* _lr_blob_input_stream_h */
@@ -0,0 +1,425 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-char-class.h"
+#include "lr-ascii-set.h"
+#include "lr-splitter.h"
+
+/*
+ * Only a small subset of the regex syntax is understood here, namely a
+ * single bracketed class of literal characters, ranges and simple escapes,
+ * followed by a '+'. This covers every language preset. Anything else
+ * (negated classes, \w and friends, POSIX classes, ...) makes the parser
+ * give up, so that the splitter falls back to GRegex.
+ */
+
+typedef struct
+{
+  gunichar first, last;
+} char_interval_t;
+
+static gboolean
+parse_hex (const gchar **ptr, int max_digits, gunichar *c)
+{
+  const gchar *p = *ptr;
+  gunichar value = 0;
+  int n_digits = 0;
+
+  while (n_digits < max_digits && g_ascii_isxdigit (*p))
+    {
+      value = value * 16 + g_ascii_xdigit_value (*p);
+      if (value > 0x10FFFF)
+        return FALSE;
+      p++;
+      n_digits++;
+    }
+
+  if (n_digits == 0)
+    return FALSE;
+
+  *ptr = p;
+  *c = value;
+  return TRUE;
+}
+
+/* Parses a single (possibly escaped) character of the class */
+static gboolean
+parse_class_char (const gchar **ptr, gunichar *c)
+{
+  const gchar *p = *ptr;
+
+  if (*p == '\0')
+    return FALSE;
+
+  if (*p == '[')
+    return FALSE; /* Possibly a POSIX class */
+
+  if (*p != '\\')
+    {
+      gunichar u = g_utf8_get_char_validated (p, -1);
+      if (u == (gunichar)-1 || u == (gunichar)-2)
+        return FALSE;
+
+      *c = u;
+      *ptr = g_utf8_next_char (p);
+      return TRUE;
+    }
+
+  p++;
+  switch (*p)
+    {
+    case 'n':
+      *c = '\n';
+      break;
+    case 'r':
+      *c = '\r';
+      break;
+    case 't':
+      *c = '\t';
+      break;
+    case 'f':
+      *c = '\f';
+      break;
+    case 'e':
+      *c = 0x1B;
+      break;
+    case 'a':
+      *c = 0x07;
+      break;
+    case 'x':
+      p++;
+      if (*p == '{')
+        {
+          p++;
+          if (!parse_hex (&p, 6, c) || *p != '}')
+            return FALSE;
+          p++;
+        }
+      else if (!parse_hex (&p, 2, c))
+        {
+          *c = 0; /* A lone \x is a NUL character in PCRE */
+        }
+      *ptr = p;
+      return TRUE;
+    default:
+      /* Escaped punctuation stands for itself, escaped letters and
+       * digits are classes, assertions or back references */
+      if (!g_ascii_ispunct (*p) && *p != ' ')
+        return FALSE;
+      *c = *p;
+      break;
+    }
+
+  *ptr = p + 1;
+  return TRUE;
+}
+
+static gint
+compare_intervals (gconstpointer a, gconstpointer b)
+{
+  const char_interval_t *first = a, *second = b;
+
+  if (first->first < second->first)
+    return -1;
+  else if (first->first == second->first)
+    return 0;
+  else
+    return 1;
+}
+
+static GArray *
+parse_class (const gchar *regex)
+{
+  const gchar *p = regex;
+
+  if (*p++ != '[')
+    return NULL;
+
+  if (*p == '^')
+    return NULL;
+
+  GArray *intervals = g_array_new (FALSE, FALSE, sizeof (char_interval_t));
+
+  /* A ']' right after the opening bracket is a literal */
+  gboolean first_item = TRUE;
+  while (*p != ']' || first_item)
+    {
+      char_interval_t interval;
+      if (first_item && *p == ']')
+        {
+          interval.first = ']';
+          p++;
+        }
+      else if (!parse_class_char (&p, &interval.first))
+        goto fail;
+
+      interval.last = interval.first;
+      first_item = FALSE;
+
+      /* A '-' followed by anything but the closing bracket is a range */
+      if (p[0] == '-' && p[1] != ']' && p[1] != '\0')
+        {
+          p++;
+          if (!parse_class_char (&p, &interval.last) || interval.last < interval.first)
+            goto fail;
+        }
+
+      g_array_append_val (intervals, interval);
+    }
+  p++; /* Skip the ']' */
+
+  /* The class has to be repeated one or more times and be the whole regex */
+  if (p[0] != '+' || p[1] != '\0')
+    goto fail;
+
+  return intervals;
+
+fail:
+  g_array_free (intervals, TRUE);
+  return NULL;
+}
+
+static void
+set_bit (guint32 *bitmap, gunichar c)
+{
+  bitmap[(c >> 5) & 7] |= 1u << (c & 31);
+}
+
+lr_char_class_t *
+lr_char_class_new_from_regex (const gchar *regex)
+{
+  g_assert (regex != NULL);
+
+  GArray *intervals = parse_class (regex);
+  if (!intervals)
+    return NULL;
+
+  g_array_sort (intervals, compare_intervals);
+
+  gunichar max_char = 0;
+  for (guint i = 0; i < intervals->len; i++)
+    max_char = MAX (max_char, g_array_index (intervals, char_interval_t, i).last);
+
+  /* Fill in the full bitmap of every block up to the highest character */
+  guint n_blocks = (max_char >> 8) + 1;
+  guint32 *full = g_new0 (guint32, n_blocks * 8);
+
+  for (guint i = 0; i < intervals->len; i++)
+    {
+      const char_interval_t *interval = &g_array_index (intervals, char_interval_t, i);
+      for (gunichar c = interval->first; c <= interval->last; c++)
+        set_bit (&full[(c >> 8) * 8], c);
+    }
+  g_array_free (intervals, TRUE);
+
+  /* Deduplicate the block bitmaps. The empty bitmap always comes first. */
+  lr_char_class_t *klass = g_new0 (lr_char_class_t, 1);
+  klass->n_blocks = n_blocks;
+  klass->index = g_new (guint16, n_blocks);
+
+  GArray *bitmaps = g_array_new (FALSE, TRUE, 8 * sizeof (guint32));
+  g_array_set_size (bitmaps, 1);
+
+  for (guint block = 0; block < n_blocks; block++)
+    {
+      const guint32 *bitmap = &full[block * 8];
+      guint unique;
+      for (unique = 0; unique < bitmaps->len; unique++)
+        {
+          const gchar *other = bitmaps->data + unique * 8 * sizeof (guint32);
+          if (memcmp (other, bitmap, 8 * sizeof (guint32)) == 0)
+            break;
+        }
+
+      if (unique == bitmaps->len)
+        g_array_append_vals (bitmaps, bitmap, 1);
+
+      klass->index[block] = unique;
+    }
+  g_free (full);
+
+  klass->bitmaps = (guint32 *)g_array_free (bitmaps, FALSE);
+
+  return klass;
+}
+
+void
+lr_char_class_free (lr_char_class_t *klass)
+{
+  if (!klass)
+    return;
+
+  g_free (klass->index);
+  g_free (klass->bitmaps);
+  g_free (klass);
+}
+
+/* Decodes the UTF-8 character at p, returning its length in bytes.
+ * Invalid or truncated sequences decode to a single (-1) character that
+ * is never part of a class.
+ */
+static inline int
+decode_char (const guchar *p, const guchar *end, gunichar *c)
+{
+  guchar lead = p[0];
+  gsize available = end - p;
+
+  if (lead < 0xC2)
+    {
+      *c = (gunichar)-1;
+      return 1;
+    }
+  else if (lead < 0xE0)
+    {
+      if (available < 2 || (p[1] & 0xC0) != 0x80)
+        goto invalid;
+      *c = ((lead & 0x1F) << 6) | (p[1] & 0x3F);
+      return 2;
+    }
+  else if (lead < 0xF0)
+    {
+      if (available < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80)
+        goto invalid;
+      *c = ((lead & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+      return 3;
+    }
+  else if (lead < 0xF5)
+    {
+      if (available < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 ||
+          (p[3] & 0xC0) != 0x80)
+        goto invalid;
+      *c = ((lead & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+      return 4;
+    }
+
+invalid:
+  *c = (gunichar)-1;
+  return 1;
+}
+
+void
+lr_char_class_split (const lr_char_class_t *klass,
+                     const gchar *text,
+                     gssize length,
+                     GArray *ranges)
+{
+  if (length < 0)
+    length = strlen (text);
+
+  const guchar *start = (const guchar *)text;
+  const guchar *end = start + length;
+  const guchar *p = start;
+
+  /* The ASCII part of the class, looked up straight from the first bitmap */
+  const guint32 *ascii = &klass->bitmaps[klass->index[0] * 8];
+
+  lr_ascii_set_t ascii_set;
+  lr_ascii_set_init (&ascii_set, ascii);
+
+  lr_range_t range;
+  gboolean in_word = FALSE;
+
+  while (p < end)
+    {
+      /* Classify a whole block at once, up to its first non-ASCII byte */
+      const guchar *scalar_end = end;
+      if (ascii_set.vectorized && end - p >= LR_ASCII_BLOCK_SIZE)
+        {
+          const guchar *block = p;
+          guint32 non_ascii;
+          guint32 members = lr_ascii_set_classify (&ascii_set, p, &non_ascii);
+
+          guint n_bytes = LR_ASCII_BLOCK_SIZE;
+          if (non_ascii)
+            n_bytes = lr_lowest_bit (non_ascii);
+
+          if (n_bytes > 0)
+            {
+              guint32 valid = (n_bytes == 32) ? G_MAXUINT32 : (1u << n_bytes) - 1;
+              members &= valid;
+
+              /* Bit i is set where byte i differs in membership from the one before */
+              guint32 changes = (members ^ ((members << 1) | in_word)) & valid;
+              while (changes)
+                {
+                  guint i = lr_lowest_bit (changes);
+                  changes &= changes - 1;
+
+                  if ((members >> i) & 1)
+                    {
+                      range.start = p + i - start;
+                    }
+                  else
+                    {
+                      range.end = p + i - start;
+                      g_array_append_val (ranges, range);
+                    }
+                }
+
+              in_word = (members >> (n_bytes - 1)) & 1;
+              p += n_bytes;
+            }
+
+          if (!non_ascii)
+            continue;
+
+          /* Decode the rest of the block one character at a time, so that
+           * mostly non-ASCII text doesn't classify a block per character */
+          scalar_end = block + LR_ASCII_BLOCK_SIZE;
+        }
+
+      while (p < scalar_end)
+        {
+          gunichar c;
+          int char_length;
+          gboolean member;
+
+          if (*p < 0x80)
+            {
+              c = *p;
+              char_length = 1;
+              member = (ascii[c >> 5] >> (c & 31)) & 1;
+            }
+          else
+            {
+              char_length = decode_char (p, end, &c);
+              member = c != (gunichar)-1 && lr_char_class_contains (klass, c);
+            }
+
+          if (member && !in_word)
+            {
+              range.start = p - start;
+              in_word = TRUE;
+            }
+          else if (!member && in_word)
+            {
+              range.end = p - start;
+              g_array_append_val (ranges, range);
+              in_word = FALSE;
+            }
+
+          p += char_length;
+        }
+    }
+
+  if (in_word)
+    {
+      range.end = length;
+      g_array_append_val (ranges, range);
+    }
+}
@@ -0,0 +1,71 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_char_class_h
+#define _lr_char_class_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A set of Unicode code points, stored as a two-level bitmap.
+ *
+ * The code points are split in blocks of 256. The index maps each block
+ * to one of the 256-bit bitmaps, so that identical blocks (most commonly
+ * the empty one) share the same bitmap. Blocks past the end of the index
+ * are empty.
+ */
+typedef struct
+{
+  guint n_blocks;
+  guint16 *index;
+  guint32 *bitmaps;
+} lr_char_class_t;
+
+/* Compiles a word regex of the form "[...]+" into a character class.
+ * Returns NULL if the regex is of any other form, in which case it has to
+ * be matched with GRegex instead.
+ */
+lr_char_class_t *lr_char_class_new_from_regex (const gchar *regex);
+void lr_char_class_free (lr_char_class_t *klass);
+
+static inline gboolean
+lr_char_class_contains (const lr_char_class_t *klass, gunichar c)
+{
+  guint block = c >> 8;
+  if (block >= klass->n_blocks)
+    return FALSE;
+
+  const guint32 *bitmap = &klass->bitmaps[klass->index[block] * 8];
+  return (bitmap[(c >> 5) & 7] >> (c & 31)) & 1;
+}
+
+/* Appends the byte ranges of all maximal runs of characters of the class
+ * in the first length bytes of text (or all of it if length is negative)
+ * to ranges, an array of lr_range_t. This gives the same matches as
+ * running the "[...]+" regex the class was compiled from.
+ */
+void lr_char_class_split (const lr_char_class_t *klass,
+                          const gchar *text,
+                          gssize length,
+                          GArray *ranges);
+
+G_END_DECLS
+
+#endif /* _lr_char_class_h */
@@ -17,8 +17,16 @@
  */
 
 #include "lr-database.h"
+#include "language_presets.h"
+#include "lr-dict-segmenter.h"
 #include "lr-lemma-instance.h"
+#include "lr-regex-cache.h"
+#include "lr-remapper.h"
+#include "lr-segmenter.h"
+#include "lr-splitter-cache.h"
+#include "lr-word-list.h"
 #include <stdio.h>
+#include <string.h>
 #include <sqlite3.h>
 
 struct _LrDatabase
@@ -84,8 +92,21 @@ struct _LrDatabase
 
   /* Get vocabulary items for text */
   sqlite3_stmt *vocabulary_by_text_id;
+
+  /* Get the cached tokenization of a text by text ID */
+  sqlite3_stmt *tokenization_by_text_id;
+
+  /* Insert or replace the cached tokenization of a text */
+  sqlite3_stmt *insert_tokenization;
+
+  /* Delete the cached tokenization of a text by text ID */
+  sqlite3_stmt *delete_tokenization_by_text_id;
 };
 
+/* The schema version this build expects, stored in PRAGMA user_version.
+ * Older databases are brought up to date by migrate_database. */
+#define SCHEMA_VERSION 7
+
 enum
 {
   PROP_PATH = 1,
@@ -97,24 +118,26 @@ static void
 prepare_sql_statements (LrDatabase *db)
 {
   g_assert (sqlite3_prepare_v2 (db->db,
-                                "SELECT ID, Code, Name, WordRegex, SeparatorRegex FROM Languages;",
+                                "SELECT ID, Code, Name, WordRegex, SeparatorRegex, Abbreviations "
+                                "FROM Languages;",
                                 -1,
                                 &db->lang_stmt,
                                 NULL) == SQLITE_OK);
 
   g_assert (sqlite3_prepare_v2 (db->db,
                                 "INSERT OR IGNORE INTO Languages (Code, Name, WordRegex, "
-                                "SeparatorRegex) VALUES (?1, ?2, ?3, ?4);",
+                                "SeparatorRegex, Abbreviations, SegmenterVersion, SegmenterWords) "
+                                "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7);",
                                 -1,
                                 &db->insert_language,
                                 NULL) == SQLITE_OK);
 
-  g_assert (
-    sqlite3_prepare_v2 (db->db,
-                        "UPDATE Languages SET Name = ?2, SeparatorRegex = ?3 WHERE ID = ?1;",
-                        -1,
-                        &db->update_language,
-                        NULL) == SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (db->db,
+                                "UPDATE Languages SET Name = ?2, SeparatorRegex = ?3, "
+                                "Abbreviations = ?4, WordRegex = ?5 WHERE ID = ?1;",
+                                -1,
+                                &db->update_language,
+                                NULL) == SQLITE_OK);
 
   g_assert (sqlite3_prepare_v2 (
               db->db, "DELETE FROM Languages WHERE ID = ?1;", -1, &db->delete_language, NULL) ==
@@ -149,7 +172,7 @@ prepare_sql_statements (LrDatabase *db)
             SQLITE_OK);
 
   g_assert (sqlite3_prepare_v2 (db->db,
-                                "SELECT ID, LemmaID, Words, Note FROM Instances WHERE TextID = ?;",
+                                "SELECT ID, LemmaID, Words, Note, Stale FROM Instances WHERE TextID = ?;",
                                 -1,
                                 &db->instances_by_text_id,
                                 NULL) == SQLITE_OK);
@@ -168,7 +191,7 @@ prepare_sql_statements (LrDatabase *db)
                                 NULL) == SQLITE_OK);
 
   g_assert (sqlite3_prepare_v2 (db->db,
-                                "UPDATE Instances SET Note = ? WHERE ID = ?;",
+                                "UPDATE Instances SET Note = ?1, Stale = ?3 WHERE ID = ?2;",
                                 -1,
                                 &db->update_instance_by_id,
                                 NULL) == SQLITE_OK);
@@ -211,6 +234,26 @@ prepare_sql_statements (LrDatabase *db)
                                 -1,
                                 &db->vocabulary_by_text_id,
                                 NULL) == SQLITE_OK);
+
+  g_assert (sqlite3_prepare_v2 (
+              db->db,
+              "SELECT RegexHash, Words, Separators FROM Tokenizations WHERE TextID = ?1;",
+              -1,
+              &db->tokenization_by_text_id,
+              NULL) == SQLITE_OK);
+
+  g_assert (sqlite3_prepare_v2 (db->db,
+                                "INSERT OR REPLACE INTO Tokenizations (TextID, RegexHash, Words, "
+                                "Separators) VALUES (?1, ?2, ?3, ?4);",
+                                -1,
+                                &db->insert_tokenization,
+                                NULL) == SQLITE_OK);
+
+  g_assert (sqlite3_prepare_v2 (db->db,
+                                "DELETE FROM Tokenizations WHERE TextID = ?1;",
+                                -1,
+                                &db->delete_tokenization_by_text_id,
+                                NULL) == SQLITE_OK);
 }
 
 static void
@@ -235,6 +278,9 @@ free_sql_statements (LrDatabase *db)
   sqlite3_finalize (db->delete_instance_by_id);
   sqlite3_finalize (db->delete_orphaned_lemma_by_id);
   sqlite3_finalize (db->vocabulary_by_text_id);
+  sqlite3_finalize (db->tokenization_by_text_id);
+  sqlite3_finalize (db->insert_tokenization);
+  sqlite3_finalize (db->delete_tokenization_by_text_id);
 }
 
 static void
@@ -270,6 +316,274 @@ delete_orphaned_lemmas (LrDatabase *self)
     }
 }
 
+static int
+get_schema_version (LrDatabase *self)
+{
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_prepare_v2 (self->db, "PRAGMA user_version;", -1, &stmt, NULL) == SQLITE_OK);
+  g_assert (sqlite3_step (stmt) == SQLITE_ROW);
+
+  int version = sqlite3_column_int (stmt, 0);
+  sqlite3_finalize (stmt);
+
+  return version;
+}
+
+static void
+exec_or_warn (LrDatabase *self, const gchar *sql)
+{
+  gchar *error_message = NULL;
+  if (sqlite3_exec (self->db, sql, NULL, NULL, &error_message) != SQLITE_OK)
+    {
+      g_critical ("Failed to migrate the database; SQLite says: '%s'", error_message);
+      sqlite3_free (error_message);
+    }
+}
+
+/* Re-encodes the semicolon separated word indices of the instances */
+static void
+encode_instance_words (LrDatabase *self)
+{
+  sqlite3_stmt *select, *update;
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "SELECT ID, Words FROM Instances WHERE typeof (Words) = 'text';",
+                                -1,
+                                &select,
+                                NULL) == SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (
+              self->db, "UPDATE Instances SET Words = ?2 WHERE ID = ?1;", -1, &update, NULL) ==
+            SQLITE_OK);
+
+  while (sqlite3_step (select) == SQLITE_ROW)
+    {
+      GArray *words = lr_word_list_parse_legacy ((const gchar *)sqlite3_column_text (select, 1));
+      GBytes *encoded = lr_word_list_encode (words);
+
+      gsize size;
+      gconstpointer data = g_bytes_get_data (encoded, &size);
+
+      sqlite3_reset (update);
+      sqlite3_bind_int (update, 1, sqlite3_column_int (select, 0));
+      if (size > 0)
+        sqlite3_bind_blob (update, 2, data, size, NULL);
+      else
+        sqlite3_bind_zeroblob (update, 2, 0);
+      if (sqlite3_step (update) != SQLITE_DONE)
+        g_warning ("Failed to encode the words of an instance; SQLite says: '%s'",
+                   sqlite3_errmsg (self->db));
+
+      g_bytes_unref (encoded);
+      g_array_free (words, TRUE);
+    }
+
+  sqlite3_finalize (select);
+  sqlite3_finalize (update);
+}
+
+/* Stores the version of the segmenter each language has now. There is no
+ * telling which one the instances were saved with, so it is assumed to be
+ * the one installed. */
+static void
+record_segmenter_versions (LrDatabase *self)
+{
+  sqlite3_stmt *select, *update;
+  g_assert (sqlite3_prepare_v2 (self->db, "SELECT ID, Code FROM Languages;", -1, &select, NULL) ==
+            SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "UPDATE Languages SET SegmenterVersion = ?2 WHERE ID = ?1;",
+                                -1,
+                                &update,
+                                NULL) == SQLITE_OK);
+
+  while (sqlite3_step (select) == SQLITE_ROW)
+    {
+      const gchar *code = (const gchar *)sqlite3_column_text (select, 1);
+
+      sqlite3_reset (update);
+      sqlite3_bind_int (update, 1, sqlite3_column_int (select, 0));
+      sqlite3_bind_int64 (update, 2, lr_segmenter_get_version_for_language (code));
+      if (sqlite3_step (update) != SQLITE_DONE)
+        g_warning ("Failed to store the segmenter version of a language; SQLite says: '%s'",
+                   sqlite3_errmsg (self->db));
+    }
+
+  sqlite3_finalize (select);
+  sqlite3_finalize (update);
+}
+
+/* Stores the word lists the segmenter versions stand for, so that the
+ * instances can be moved to the words of a new list. The installed list
+ * is only the right one if the versions match. */
+static void
+record_segmenter_words (LrDatabase *self)
+{
+  sqlite3_stmt *select, *update;
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "SELECT ID, Code, SegmenterVersion FROM Languages "
+                                "WHERE SegmenterVersion != 0;",
+                                -1,
+                                &select,
+                                NULL) == SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "UPDATE Languages SET SegmenterWords = ?2 WHERE ID = ?1;",
+                                -1,
+                                &update,
+                                NULL) == SQLITE_OK);
+
+  while (sqlite3_step (select) == SQLITE_ROW)
+    {
+      const gchar *code = (const gchar *)sqlite3_column_text (select, 1);
+      GBytes *word_list = lr_dict_segmenter_find_word_list (code);
+      if (!word_list)
+        continue;
+
+      if (lr_dict_segmenter_hash_word_list (word_list) == (guint64)sqlite3_column_int64 (select, 2))
+        {
+          gsize size;
+          gconstpointer data = g_bytes_get_data (word_list, &size);
+
+          sqlite3_reset (update);
+          sqlite3_bind_int (update, 1, sqlite3_column_int (select, 0));
+          sqlite3_bind_blob (update, 2, data, size, SQLITE_STATIC);
+          if (sqlite3_step (update) != SQLITE_DONE)
+            g_warning ("Failed to store the word list of a language; SQLite says: '%s'",
+                       sqlite3_errmsg (self->db));
+        }
+
+      g_bytes_unref (word_list);
+    }
+
+  sqlite3_finalize (select);
+  sqlite3_finalize (update);
+}
+
+/* Binds the version and the word list of the language's segmenter, which
+ * the words of its instances refer to, or 0 and NULL if it has none */
+static void
+bind_segmenter (sqlite3_stmt *stmt, int version_index, int words_index, const gchar *code)
+{
+  GBytes *word_list = lr_dict_segmenter_find_word_list (code);
+  if (!word_list)
+    {
+      sqlite3_bind_int64 (stmt, version_index, 0);
+      sqlite3_bind_null (stmt, words_index);
+      return;
+    }
+
+  gsize size;
+  gconstpointer data = g_bytes_get_data (word_list, &size);
+  sqlite3_bind_int64 (stmt, version_index, lr_dict_segmenter_hash_word_list (word_list));
+  sqlite3_bind_blob (stmt, words_index, data, size, SQLITE_TRANSIENT);
+
+  g_bytes_unref (word_list);
+}
+
+/* The separator regex the presets had before they got abbreviations */
+#define LEGACY_PRESET_SEPARATOR_REGEX "(?<!etc)([\\.!?][ \\n]*)"
+
+/* Moves the languages still using the separator regex of their preset to
+ * the preset's current regex and abbreviations */
+static void
+update_preset_separators (LrDatabase *self)
+{
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "UPDATE Languages SET SeparatorRegex = ?2, Abbreviations = ?3 "
+                                "WHERE Code = ?1 AND SeparatorRegex = ?4 AND Abbreviations = '';",
+                                -1,
+                                &stmt,
+                                NULL) == SQLITE_OK);
+
+  for (guint i = 0; i < G_N_ELEMENTS (presets); i++)
+    {
+      sqlite3_reset (stmt);
+      sqlite3_bind_text (stmt, 1, presets[i].code, -1, NULL);
+      sqlite3_bind_text (stmt, 2, presets[i].separator_regex, -1, NULL);
+      sqlite3_bind_text (stmt, 3, presets[i].abbreviations, -1, NULL);
+      sqlite3_bind_text (stmt, 4, LEGACY_PRESET_SEPARATOR_REGEX, -1, NULL);
+      if (sqlite3_step (stmt) != SQLITE_DONE)
+        g_warning ("Failed to update the separators of a language; SQLite says: '%s'",
+                   sqlite3_errmsg (self->db));
+    }
+
+  sqlite3_finalize (stmt);
+}
+
+/* Upgrades databases created by older versions to the current schema.
+ * Every step is applied in order, inside a single transaction. */
+static void
+migrate_database (LrDatabase *self)
+{
+  int version = get_schema_version (self);
+  if (version >= SCHEMA_VERSION)
+    return;
+
+  exec_or_warn (self, "BEGIN TRANSACTION;");
+
+  if (version < 1)
+    {
+      /* Cached word and separator ranges of each text */
+      exec_or_warn (self,
+                    "CREATE TABLE IF NOT EXISTS \"Tokenizations\" ("
+                    " \"TextID\" INTEGER NOT NULL PRIMARY KEY,"
+                    " \"RegexHash\" INTEGER NOT NULL,"
+                    " \"Words\" BLOB NOT NULL,"
+                    " \"Separators\" BLOB NOT NULL,"
+                    " FOREIGN KEY(\"TextID\") REFERENCES \"Texts\"(\"ID\")"
+                    " ON DELETE CASCADE);");
+    }
+
+  if (version < 2)
+    {
+      /* The words of the instances are varint encoded blobs */
+      encode_instance_words (self);
+    }
+
+  if (version < 3)
+    {
+      /* Abbreviations for the sentence detector */
+      exec_or_warn (self,
+                    "ALTER TABLE \"Languages\" ADD COLUMN"
+                    " \"Abbreviations\" TEXT NOT NULL DEFAULT '';");
+    }
+
+  if (version < 4)
+    {
+      /* Instances that lost words when their text was edited */
+      exec_or_warn (self,
+                    "ALTER TABLE \"Instances\" ADD COLUMN"
+                    " \"Stale\" INTEGER NOT NULL DEFAULT 0;");
+    }
+
+  if (version < 5)
+    {
+      /* The segmenter version the words of the instances refer to */
+      exec_or_warn (self,
+                    "ALTER TABLE \"Languages\" ADD COLUMN"
+                    " \"SegmenterVersion\" INTEGER NOT NULL DEFAULT 0;");
+      record_segmenter_versions (self);
+    }
+
+  if (version < 6)
+    {
+      /* Sentences are split with the abbreviations of the presets */
+      update_preset_separators (self);
+    }
+
+  if (version < 7)
+    {
+      /* The word list the segmenter version stands for */
+      exec_or_warn (self, "ALTER TABLE \"Languages\" ADD COLUMN \"SegmenterWords\" BLOB;");
+      record_segmenter_words (self);
+    }
+
+  gchar *pragma = g_strdup_printf ("PRAGMA user_version = %d;", SCHEMA_VERSION);
+  exec_or_warn (self, pragma);
+  g_free (pragma);
+
+  exec_or_warn (self, "COMMIT;");
+}
+
 static void
 open_database (LrDatabase *self)
 {
@@ -285,6 +599,11 @@ open_database (LrDatabase *self)
 
   enable_foreign_keys (self);
 
+  /* Background jobs write through connections of their own */
+  sqlite3_busy_timeout (self->db, LR_DATABASE_BUSY_TIMEOUT);
+
+  migrate_database (self);
+
   prepare_sql_statements (self);
 }
 
@@ -345,6 +664,14 @@ lr_database_new (gchar *path)
   return g_object_new (LR_TYPE_DATABASE, "path", path, NULL);
 }
 
+const gchar *
+lr_database_get_path (LrDatabase *self)
+{
+  g_assert (LR_IS_DATABASE (self));
+
+  return self->db_path;
+}
+
 void
 lr_database_insert_language (LrDatabase *self, LrLanguage *language)
 {
@@ -358,6 +685,8 @@ lr_database_insert_language (LrDatabase *self, LrLanguage *language)
   sqlite3_bind_text (stmt, 2, lr_language_get_name (language), -1, NULL);
   sqlite3_bind_text (stmt, 3, lr_language_get_word_regex (language), -1, NULL);
   sqlite3_bind_text (stmt, 4, lr_language_get_separator_regex (language), -1, NULL);
+  sqlite3_bind_text (stmt, 5, lr_language_get_abbreviations (language), -1, NULL);
+  bind_segmenter (stmt, 6, 7, lr_language_get_code (language));
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 }
@@ -374,8 +703,14 @@ lr_database_update_language (LrDatabase *self, LrLanguage *language)
   sqlite3_bind_int (stmt, 1, lr_language_get_id (language));
   sqlite3_bind_text (stmt, 2, lr_language_get_name (language), -1, NULL);
   sqlite3_bind_text (stmt, 3, lr_language_get_separator_regex (language), -1, NULL);
+  sqlite3_bind_text (stmt, 4, lr_language_get_abbreviations (language), -1, NULL);
+  sqlite3_bind_text (stmt, 5, lr_language_get_word_regex (language), -1, NULL);
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+
+  /* The regexes may have changed */
+  lr_regex_cache_invalidate_language (lr_language_get_id (language));
+  lr_splitter_cache_invalidate_language (lr_language_get_id (language));
 }
 
 void
@@ -390,6 +725,9 @@ lr_database_delete_language (LrDatabase *self, LrLanguage *language)
   sqlite3_bind_int (stmt, 1, lr_language_get_id (language));
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+
+  lr_regex_cache_invalidate_language (lr_language_get_id (language));
+  lr_splitter_cache_invalidate_language (lr_language_get_id (language));
 }
 
 void
@@ -409,8 +747,10 @@ lr_database_populate_languages (LrDatabase *self, GListStore *store)
       const gchar *name = (const gchar *)sqlite3_column_text (self->lang_stmt, 2);
       const gchar *word_regex = (const gchar *)sqlite3_column_text (self->lang_stmt, 3);
       const gchar *separator_regex = (const gchar *)sqlite3_column_text (self->lang_stmt, 4);
+      const gchar *abbreviations = (const gchar *)sqlite3_column_text (self->lang_stmt, 5);
 
       LrLanguage *lang = lr_language_new (id, code, name, word_regex, separator_regex);
+      lr_language_set_abbreviations (lang, abbreviations);
 
       g_list_store_append (store, lang);
 
@@ -464,10 +804,12 @@ lr_database_populate_lemma_instances (LrDatabase *self, GListStore *instance_sto
     {
       int id = sqlite3_column_int (stmt, 0);
       int lemma_id = sqlite3_column_int (stmt, 1);
-      const gchar *words = (const gchar *)sqlite3_column_text (stmt, 2);
+      GBytes *words = g_bytes_new (sqlite3_column_blob (stmt, 2), sqlite3_column_bytes (stmt, 2));
       const gchar *note = (const gchar *)sqlite3_column_text (stmt, 3);
 
       LrLemmaInstance *instance = lr_lemma_instance_new (id, lemma_id, text, words, note);
+      lr_lemma_instance_set_stale (instance, sqlite3_column_int (stmt, 4));
+      g_bytes_unref (words);
 
       g_list_store_append (instance_store, instance);
       g_clear_object (&instance);
@@ -536,6 +878,68 @@ lr_database_insert_text (LrDatabase *self, LrText *text)
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 }
 
+/* Moves the instances of the text from the words of the old contents to
+ * the words of the new ones, flagging those which lost words */
+static void
+remap_instances (LrDatabase *self,
+                 LrText *text,
+                 LrSplitter *old_splitter,
+                 LrSplitter *new_splitter)
+{
+  GArray *map = lr_remap_diff_words (old_splitter, new_splitter);
+  int n_new_words = lr_splitter_get_n_words (new_splitter);
+
+  sqlite3_stmt *select, *update;
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "SELECT ID, Words FROM Instances WHERE TextID = ?1;",
+                                -1,
+                                &select,
+                                NULL) == SQLITE_OK);
+  g_assert (sqlite3_prepare_v2 (self->db,
+                                "UPDATE Instances SET Words = ?2, Stale = Stale OR ?3 WHERE ID = ?1;",
+                                -1,
+                                &update,
+                                NULL) == SQLITE_OK);
+
+  GArray *old = g_array_new (FALSE, FALSE, sizeof (int));
+  GArray *new = g_array_new (FALSE, FALSE, sizeof (int));
+
+  sqlite3_bind_int (select, 1, lr_text_get_id (text));
+  while (sqlite3_step (select) == SQLITE_ROW)
+    {
+      g_array_set_size (old, 0);
+      if (!lr_word_list_decode (
+            sqlite3_column_blob (select, 1), sqlite3_column_bytes (select, 1), old))
+        continue;
+
+      gboolean kept = lr_remap_instance_words (map, n_new_words, old, new);
+      if (kept && old->len == new->len &&
+          memcmp (old->data, new->data, old->len * sizeof (int)) == 0)
+        continue;
+
+      GBytes *encoded = lr_word_list_encode (new);
+      gsize size;
+      gconstpointer data = g_bytes_get_data (encoded, &size);
+
+      sqlite3_reset (update);
+      sqlite3_bind_int (update, 1, sqlite3_column_int (select, 0));
+      if (size > 0)
+        sqlite3_bind_blob (update, 2, data, size, NULL);
+      else
+        sqlite3_bind_zeroblob (update, 2, 0);
+      sqlite3_bind_int (update, 3, !kept);
+      g_assert (sqlite3_step (update) == SQLITE_DONE);
+
+      g_bytes_unref (encoded);
+    }
+
+  sqlite3_finalize (select);
+  sqlite3_finalize (update);
+  g_array_free (old, TRUE);
+  g_array_free (new, TRUE);
+  g_array_free (map, TRUE);
+}
+
 void
 lr_database_update_text (LrDatabase *self, LrText *text)
 {
@@ -545,7 +949,45 @@ lr_database_update_text (LrDatabase *self, LrText *text)
   /* Make sure the text has been loaded first */
   g_assert (lr_text_get_text (text) != NULL);
 
-  sqlite3_stmt *stmt = self->update_text_by_id;
+  g_assert (sqlite3_exec (self->db, "BEGIN TRANSACTION;", NULL, NULL, NULL) == SQLITE_OK);
+
+  /* The instances refer to the words of the stored contents */
+  gchar *old_contents = NULL;
+  sqlite3_stmt *stmt = self->text_text_by_id;
+  sqlite3_reset (stmt);
+  sqlite3_bind_int (stmt, 1, lr_text_get_id (text));
+  if (sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      const gchar *contents = (const gchar *)sqlite3_column_text (stmt, 0);
+      if (contents && g_strcmp0 (contents, lr_text_get_text (text)) != 0)
+        old_contents = g_strdup (contents);
+    }
+  sqlite3_reset (stmt);
+
+  if (old_contents)
+    {
+      /* Take the old words from the cached tokenization, then drop it so
+       * that the new contents are split and cached in its place */
+      LrText *old_text =
+        lr_text_new (lr_text_get_id (text), lr_text_get_language (text), "", "");
+      lr_text_set_text (old_text, old_contents);
+      LrSplitter *old_splitter = lr_splitter_cache_lookup (old_text, self);
+
+      stmt = self->delete_tokenization_by_text_id;
+      sqlite3_reset (stmt);
+      sqlite3_bind_int (stmt, 1, lr_text_get_id (text));
+      g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+
+      LrSplitter *new_splitter = lr_splitter_new_with_database (text, self);
+      remap_instances (self, text, old_splitter, new_splitter);
+
+      g_object_unref (old_splitter);
+      g_object_unref (new_splitter);
+      g_object_unref (old_text);
+      g_free (old_contents);
+    }
+
+  stmt = self->update_text_by_id;
   sqlite3_reset (stmt);
 
   sqlite3_bind_text (stmt, 1, lr_text_get_title (text), -1, NULL);
@@ -555,6 +997,10 @@ lr_database_update_text (LrDatabase *self, LrText *text)
   sqlite3_bind_int (stmt, 4, lr_text_get_id (text));
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+
+  g_assert (sqlite3_exec (self->db, "COMMIT;", NULL, NULL, NULL) == SQLITE_OK);
+
+  lr_splitter_cache_invalidate_text (lr_text_get_id (text));
 }
 
 void
@@ -569,6 +1015,8 @@ lr_database_delete_text (LrDatabase *self, LrText *text)
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 
+  lr_splitter_cache_invalidate_text (lr_text_get_id (text));
+
   delete_orphaned_lemmas (self);
 }
 
@@ -598,6 +1046,7 @@ lr_database_update_instance (LrDatabase *self, LrLemmaInstance *instance)
 
   sqlite3_bind_text (stmt, 1, lr_lemma_instance_get_note (instance), -1, NULL);
   sqlite3_bind_int (stmt, 2, lr_lemma_instance_get_id (instance));
+  sqlite3_bind_int (stmt, 3, lr_lemma_instance_get_stale (instance));
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 }
@@ -640,11 +1089,16 @@ lr_database_insert_instance (LrDatabase *self, LrLemmaInstance *instance)
 
   int lemma_id = lr_lemma_instance_get_lemma_id (instance);
   int text_id = lr_text_get_id (lr_lemma_instance_get_text (instance));
-  const gchar *words = lr_lemma_instance_get_words (instance);
+  gsize words_size;
+  gconstpointer words = g_bytes_get_data (lr_lemma_instance_get_words (instance), &words_size);
 
   sqlite3_bind_int (stmt, 1, lemma_id);
   sqlite3_bind_int (stmt, 2, text_id);
-  sqlite3_bind_text (stmt, 3, words, -1, NULL);
+  /* A NULL blob would be bound as NULL, not as an empty blob */
+  if (words_size > 0)
+    sqlite3_bind_blob (stmt, 3, words, words_size, NULL);
+  else
+    sqlite3_bind_zeroblob (stmt, 3, 0);
 
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 
@@ -672,6 +1126,59 @@ lr_database_delete_instance (LrDatabase *self, LrLemmaInstance *instance)
   g_assert (sqlite3_step (stmt) == SQLITE_DONE);
 }
 
+gboolean
+lr_database_load_tokenization (LrDatabase *self,
+                               LrText *text,
+                               gint64 regex_hash,
+                               GBytes **words,
+                               GBytes **separators)
+{
+  g_assert (LR_IS_DATABASE (self));
+  g_assert (LR_IS_TEXT (text));
+
+  sqlite3_stmt *stmt = self->tokenization_by_text_id;
+  sqlite3_reset (stmt);
+
+  sqlite3_bind_int (stmt, 1, lr_text_get_id (text));
+
+  if (sqlite3_step (stmt) != SQLITE_ROW)
+    return FALSE;
+
+  /* Tokenized with different regexes */
+  if (sqlite3_column_int64 (stmt, 0) != regex_hash)
+    return FALSE;
+
+  *words = g_bytes_new (sqlite3_column_blob (stmt, 1), sqlite3_column_bytes (stmt, 1));
+  *separators = g_bytes_new (sqlite3_column_blob (stmt, 2), sqlite3_column_bytes (stmt, 2));
+
+  return TRUE;
+}
+
+void
+lr_database_store_tokenization (LrDatabase *self,
+                                LrText *text,
+                                gint64 regex_hash,
+                                GBytes *words,
+                                GBytes *separators)
+{
+  g_assert (LR_IS_DATABASE (self));
+  g_assert (LR_IS_TEXT (text));
+
+  sqlite3_stmt *stmt = self->insert_tokenization;
+  sqlite3_reset (stmt);
+
+  gsize words_size, separators_size;
+  gconstpointer words_data = g_bytes_get_data (words, &words_size);
+  gconstpointer separators_data = g_bytes_get_data (separators, &separators_size);
+
+  sqlite3_bind_int (stmt, 1, lr_text_get_id (text));
+  sqlite3_bind_int64 (stmt, 2, regex_hash);
+  sqlite3_bind_blob (stmt, 3, words_data, words_size, NULL);
+  sqlite3_bind_blob (stmt, 4, separators_data, separators_size, NULL);
+
+  g_assert (sqlite3_step (stmt) == SQLITE_DONE);
+}
+
 GList *
 lr_database_get_vocabulary_items_for_text (LrDatabase *self, LrText *text)
 {
@@ -688,13 +1195,13 @@ lr_database_get_vocabulary_items_for_text (LrDatabase *self, LrText *text)
   while (sqlite3_step (stmt) == SQLITE_ROW)
     {
       lr_vocabulary_item_t *item = (lr_vocabulary_item_t *)g_malloc (sizeof (*item));
-      const char *words = (const char *)sqlite3_column_text (stmt, 0);
+      GBytes *words = g_bytes_new (sqlite3_column_blob (stmt, 0), sqlite3_column_bytes (stmt, 0));
       const char *lemma = (const char *)sqlite3_column_text (stmt, 1);
       const char *translation = (const char *)sqlite3_column_text (stmt, 2);
       const char *note = (const char *)sqlite3_column_text (stmt, 3);
 
       item->text = text;
-      item->words = g_strdup (words);
+      item->words = words;
       item->lemma = g_strdup (lemma);
       item->translation = g_strdup (translation);
       item->note = g_strdup (note);
@@ -708,7 +1215,7 @@ lr_database_get_vocabulary_items_for_text (LrDatabase *self, LrText *text)
 void
 lr_vocabulary_item_free (lr_vocabulary_item_t *self)
 {
-  g_free (self->words);
+  g_bytes_unref (self->words);
   g_free (self->lemma);
   g_free (self->translation);
   g_free (self->note);
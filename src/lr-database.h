@@ -32,9 +32,16 @@ G_BEGIN_DECLS
 #define LR_TYPE_DATABASE (lr_database_get_type ())
 G_DECLARE_FINAL_TYPE (LrDatabase, lr_database, LR, DATABASE, GObject)
 
+/* How many milliseconds a connection waits for another one (of the
+ * database or of a background job) to release the database */
+#define LR_DATABASE_BUSY_TIMEOUT 10000
+
 LrDatabase *lr_database_new (gchar *path);
 void lr_database_close (LrDatabase *self);
 
+/* The path of the SQLite file, for jobs which open connections of their own */
+const gchar *lr_database_get_path (LrDatabase *self);
+
 void lr_database_insert_language (LrDatabase *self, LrLanguage *language);
 void lr_database_update_language (LrDatabase *self, LrLanguage *language);
 void lr_database_delete_language (LrDatabase *self, LrLanguage *language);
@@ -59,11 +66,23 @@ void lr_database_insert_instance (LrDatabase *self, LrLemmaInstance *instance);
 
 void lr_database_delete_instance (LrDatabase *self, LrLemmaInstance *instance);
 
+/* Tokenization cache, see LrSplitter */
+gboolean lr_database_load_tokenization (LrDatabase *self,
+                                        LrText *text,
+                                        gint64 regex_hash,
+                                        GBytes **words,
+                                        GBytes **separators);
+void lr_database_store_tokenization (LrDatabase *self,
+                                     LrText *text,
+                                     gint64 regex_hash,
+                                     GBytes *words,
+                                     GBytes *separators);
+
 /* Vocabulary export functions */
 typedef struct
 {
   LrText *text;
-  char *words;
+  GBytes *words;
   char *lemma;
   char *translation;
   char *note;
@@ -45,6 +45,9 @@ struct _LrDbLemmatizer
   sqlite3 *db;
 
   sqlite3_stmt *query;
+
+  /* Lookups run on worker threads, but share the query */
+  GMutex lock;
 };
 
 enum
@@ -63,6 +66,7 @@ G_DEFINE_TYPE (LrDbLemmatizer, lr_db_lemmatizer, LR_TYPE_LEMMATIZER)
 static void
 lr_db_lemmatizer_init (LrDbLemmatizer *self)
 {
+  g_mutex_init (&self->lock);
 }
 
 static void
@@ -106,6 +110,7 @@ lr_db_lemmatizer_finalize (GObject *object)
 
   sqlite3_finalize (self->query);
   sqlite3_close (self->db);
+  g_mutex_clear (&self->lock);
 
   G_OBJECT_CLASS (lr_db_lemmatizer_parent_class)->finalize (object);
 }
@@ -148,7 +153,7 @@ static gchar *
 db_lemmatizer_populate_suggestions (LrLemmatizer *base,
                                     GListStore *store,
                                     const char *text,
-                                    GList *selection)
+                                    GArray *selection)
 {
   LrDbLemmatizer *self = LR_DB_LEMMATIZER (base);
 
@@ -157,7 +162,7 @@ db_lemmatizer_populate_suggestions (LrLemmatizer *base,
       return g_strdup ("No lemma suggestions\nfor this language.");
     }
 
-  int selected_words = g_list_length (selection);
+  int selected_words = selection->len;
   if (selected_words > 1)
     {
       return g_strdup ("This lemmatizer only works with single words");
@@ -167,11 +172,12 @@ db_lemmatizer_populate_suggestions (LrLemmatizer *base,
       return g_strdup ("No words selected");
     }
 
-  const lr_range_t *range = selection->data;
-  gchar *word = g_strndup (text + range->start, (range->end - range->start));
+  /* Bind the word straight from the text, without copying it */
+  const lr_range_t *range = &g_array_index (selection, lr_range_t, 0);
 
+  g_mutex_lock (&self->lock);
   sqlite3_reset (self->query);
-  sqlite3_bind_text (self->query, 1, word, -1, NULL);
+  sqlite3_bind_text (self->query, 1, text + range->start, range->end - range->start, NULL);
 
   while (sqlite3_step (self->query) == SQLITE_ROW)
     {
@@ -181,7 +187,10 @@ db_lemmatizer_populate_suggestions (LrLemmatizer *base,
       g_list_store_append (store, suggestion);
     }
 
-  g_free (word);
+  /* Unbind the text, it doesn't outlive the lookup */
+  sqlite3_reset (self->query);
+  g_mutex_unlock (&self->lock);
+
   int n_items = g_list_model_get_n_items (G_LIST_MODEL (store));
   return g_strdup_printf ("%d possible %s", n_items, n_items == 1 ? "lemma" : "lemmas");
 }
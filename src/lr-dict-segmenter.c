@@ -0,0 +1,409 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-dict-segmenter.h"
+#include "lr-splitter.h"
+#include <string.h>
+
+/*
+ * NOTE:
+ *
+ * The word lists are plain UTF-8 files named after the language code, e.g.
+ * langrise/word_lists/zh.words in one of the system data directories, with
+ * one word per line. Anything after a tab on a line (such as a frequency)
+ * is ignored, and so are empty lines and lines starting with '#'.
+ *
+ * Runs of word characters are segmented by forward maximal matching: the
+ * longest word of the list starting at the current position is taken, or
+ * a single character if there is none.
+ */
+
+/*
+ * The words are stored in a double-array trie over their UTF-8 bytes: the
+ * child of state s on byte c is base[s] + c, provided its check is s. Each
+ * step of the matching loop is then two adjacent loads, whatever the
+ * number of children.
+ */
+typedef struct
+{
+  guint32 base : 31;
+  guint32 is_word : 1;
+  gint32 check; /* The parent state, or -1 for free cells */
+} trie_cell_t;
+
+struct _LrDictSegmenter
+{
+  LrSegmenter parent_instance;
+
+  GBytes *word_list;
+  guint64 version;
+
+  trie_cell_t *cells;
+  guint n_cells;
+};
+
+enum
+{
+  PROP_0,
+  PROP_WORD_LIST,
+  N_PROPERTIES
+};
+
+static GParamSpec *obj_properties[N_PROPERTIES] = {
+  NULL,
+};
+
+G_DEFINE_TYPE (LrDictSegmenter, lr_dict_segmenter, LR_TYPE_SEGMENTER)
+
+/* State used only while building the trie */
+typedef struct
+{
+  trie_cell_t *cells;
+  guint n_cells;
+
+  /* Cells before this one are (almost) all taken */
+  guint next_check_pos;
+
+  /* The highest cell in use */
+  guint max_used;
+} trie_builder_t;
+
+static void
+ensure_cells (trie_builder_t *builder, guint n_cells)
+{
+  if (n_cells <= builder->n_cells)
+    return;
+
+  guint new_size = MAX (n_cells, builder->n_cells * 2);
+  builder->cells = g_renew (trie_cell_t, builder->cells, new_size);
+  for (guint i = builder->n_cells; i < new_size; i++)
+    {
+      builder->cells[i].base = 0;
+      builder->cells[i].is_word = 0;
+      builder->cells[i].check = -1;
+    }
+  builder->n_cells = new_size;
+}
+
+/* Finds a base for which the cells of all the children are free */
+static guint
+find_base (trie_builder_t *builder, const guint8 *labels, guint n_labels)
+{
+  guint pos = MAX (builder->next_check_pos, (guint)labels[0] + 1);
+  guint first_free = 0;
+  guint n_taken = 0;
+
+  for (;; pos++)
+    {
+      ensure_cells (builder, pos + 257);
+
+      if (builder->cells[pos].check != -1)
+        {
+          n_taken++;
+          continue;
+        }
+
+      if (!first_free)
+        first_free = pos;
+
+      guint base = pos - labels[0];
+      gboolean fits = TRUE;
+      for (guint i = 1; i < n_labels && fits; i++)
+        fits = builder->cells[base + labels[i]].check == -1;
+
+      if (fits)
+        break;
+    }
+
+  /* Stop searching the dense start of the array again and again */
+  if (first_free && n_taken * 20 >= (pos - builder->next_check_pos + 1) * 19)
+    builder->next_check_pos = first_free;
+
+  return pos - labels[0];
+}
+
+/* Adds the sorted words, which share their first depth bytes, under state */
+static void
+build_trie (trie_builder_t *builder, gchar **words, guint n_words, guint depth, guint state)
+{
+  guint i = 0;
+
+  /* Words ending here come first */
+  while (i < n_words && words[i][depth] == '\0')
+    {
+      builder->cells[state].is_word = 1;
+      i++;
+    }
+
+  if (i == n_words)
+    return;
+
+  /* Collect the distinct next bytes */
+  guint8 labels[256];
+  guint n_labels = 0;
+  for (guint j = i; j < n_words; j++)
+    {
+      guint8 c = words[j][depth];
+      if (n_labels == 0 || labels[n_labels - 1] != c)
+        labels[n_labels++] = c;
+    }
+
+  /* Claim the cells of all children before descending into any of them */
+  guint base = find_base (builder, labels, n_labels);
+  builder->cells[state].base = base;
+  for (guint j = 0; j < n_labels; j++)
+    builder->cells[base + labels[j]].check = state;
+  builder->max_used = MAX (builder->max_used, base + labels[n_labels - 1]);
+
+  for (guint j = 0; j < n_labels; j++)
+    {
+      guint start = i;
+      while (i < n_words && (guint8)words[i][depth] == labels[j])
+        i++;
+
+      build_trie (builder, words + start, i - start, depth + 1, base + labels[j]);
+    }
+}
+
+static gint
+compare_words (gconstpointer first, gconstpointer second)
+{
+  return strcmp (*(gchar *const *)first, *(gchar *const *)second);
+}
+
+static void
+load_word_list (LrDictSegmenter *self)
+{
+  gsize size;
+  const gchar *data = g_bytes_get_data (self->word_list, &size);
+  self->version = lr_dict_segmenter_hash_word_list (self->word_list);
+
+  /* Cut the list into NUL-terminated words in a copy */
+  gchar *copy = g_strndup (data, size);
+  GPtrArray *words = g_ptr_array_new ();
+
+  gchar *line = copy;
+  while (line && *line)
+    {
+      gchar *next = strchr (line, '\n');
+      if (next)
+        *next++ = '\0';
+
+      line[strcspn (line, "\t\r")] = '\0';
+      if (*line && *line != '#')
+        g_ptr_array_add (words, line);
+
+      line = next;
+    }
+
+  g_ptr_array_sort (words, compare_words);
+
+  trie_builder_t builder = { NULL, 0, 1, 0 };
+  ensure_cells (&builder, 1024);
+  builder.cells[0].check = 0; /* The root */
+
+  if (words->len > 0)
+    build_trie (&builder, (gchar **)words->pdata, words->len, 0, 0);
+
+  /* Drop the free cells at the end */
+  self->n_cells = builder.max_used + 1;
+  self->cells = g_renew (trie_cell_t, builder.cells, self->n_cells);
+
+  g_ptr_array_free (words, TRUE);
+  g_free (copy);
+}
+
+/* Returns the length of the longest word text starts with, or 0 */
+static inline gsize
+longest_match (const trie_cell_t *cells, guint n_cells, const guint8 *text, gsize length)
+{
+  guint state = 0;
+  gsize longest = 0;
+
+  for (gsize i = 0; i < length; i++)
+    {
+      guint base = cells[state].base;
+      guint next = base + text[i];
+      if (base == 0 || next >= n_cells || cells[next].check != (gint32)state)
+        break;
+
+      state = next;
+      if (cells[state].is_word)
+        longest = i + 1;
+    }
+
+  return longest;
+}
+
+static void
+dict_segmenter_segment (
+  LrSegmenter *base, const gchar *text, gsize length, int offset, GArray *words)
+{
+  LrDictSegmenter *self = LR_DICT_SEGMENTER (base);
+  const guint8 *p = (const guint8 *)text;
+
+  gsize pos = 0;
+  while (pos < length)
+    {
+      gsize word_length = longest_match (self->cells, self->n_cells, p + pos, length - pos);
+
+      /* Unknown characters are words of their own */
+      if (word_length == 0)
+        word_length = MIN ((gsize)(g_utf8_next_char (text + pos) - (text + pos)), length - pos);
+
+      lr_range_t range = { offset + pos, offset + pos + word_length };
+      g_array_append_val (words, range);
+
+      pos += word_length;
+    }
+}
+
+static guint64
+dict_segmenter_get_version (LrSegmenter *base)
+{
+  return LR_DICT_SEGMENTER (base)->version;
+}
+
+static void
+lr_dict_segmenter_init (LrDictSegmenter *self)
+{
+}
+
+static void
+lr_dict_segmenter_constructed (GObject *object)
+{
+  LrDictSegmenter *self = LR_DICT_SEGMENTER (object);
+  g_assert (self->word_list != NULL);
+
+  load_word_list (self);
+
+  G_OBJECT_CLASS (lr_dict_segmenter_parent_class)->constructed (object);
+}
+
+static void
+lr_dict_segmenter_finalize (GObject *object)
+{
+  LrDictSegmenter *self = LR_DICT_SEGMENTER (object);
+
+  g_free (self->cells);
+  g_clear_pointer (&self->word_list, g_bytes_unref);
+
+  G_OBJECT_CLASS (lr_dict_segmenter_parent_class)->finalize (object);
+}
+
+static void
+lr_dict_segmenter_set_property (GObject *object,
+                                guint property_id,
+                                const GValue *value,
+                                GParamSpec *pspec)
+{
+  LrDictSegmenter *self = LR_DICT_SEGMENTER (object);
+
+  switch (property_id)
+    {
+    case PROP_WORD_LIST:
+      g_clear_pointer (&self->word_list, g_bytes_unref);
+      self->word_list = g_value_dup_boxed (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+lr_dict_segmenter_class_init (LrDictSegmenterClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->constructed = lr_dict_segmenter_constructed;
+  object_class->finalize = lr_dict_segmenter_finalize;
+  object_class->set_property = lr_dict_segmenter_set_property;
+
+  LrSegmenterClass *segmenter_class = LR_SEGMENTER_CLASS (klass);
+  segmenter_class->segment = dict_segmenter_segment;
+  segmenter_class->get_version = dict_segmenter_get_version;
+
+  obj_properties[PROP_WORD_LIST] =
+    g_param_spec_boxed ("word-list",
+                        "Word list",
+                        "The contents of the word list file.",
+                        G_TYPE_BYTES,
+                        G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY);
+
+  g_object_class_install_properties (object_class, N_PROPERTIES, obj_properties);
+}
+
+guint64
+lr_dict_segmenter_hash_word_list (GBytes *word_list)
+{
+  gsize size;
+  const gchar *data = g_bytes_get_data (word_list, &size);
+
+  /* FNV-1a hash of the list, which identifies the segmentation */
+  guint64 hash = 0xcbf29ce484222325ull;
+  for (gsize i = 0; i < size; i++)
+    {
+      hash ^= (guint8)data[i];
+      hash *= 0x100000001b3ull;
+    }
+
+  return hash;
+}
+
+GBytes *
+lr_dict_segmenter_find_word_list (const gchar *code)
+{
+  gchar *filename = g_strdup_printf ("%s.words", code);
+
+  /* Use the first word list found in the data directories */
+  GBytes *word_list = NULL;
+  const gchar *const *data_dirs = g_get_system_data_dirs ();
+  for (const gchar *const *str = &data_dirs[0]; *str != NULL && !word_list; str++)
+    {
+      gchar *path = g_build_filename (*str, "langrise", "word_lists", filename, NULL);
+
+      gchar *contents;
+      gsize length;
+      if (g_file_get_contents (path, &contents, &length, NULL))
+        word_list = g_bytes_new_take (contents, length);
+
+      g_free (path);
+    }
+
+  g_free (filename);
+
+  return word_list;
+}
+
+LrSegmenter *
+lr_dict_segmenter_new_from_word_list (GBytes *word_list)
+{
+  return g_object_new (LR_TYPE_DICT_SEGMENTER, "word-list", word_list, NULL);
+}
+
+LrSegmenter *
+lr_dict_segmenter_new (const gchar *code)
+{
+  GBytes *word_list = lr_dict_segmenter_find_word_list (code);
+  if (!word_list)
+    return NULL;
+
+  LrSegmenter *segmenter = lr_dict_segmenter_new_from_word_list (word_list);
+  g_bytes_unref (word_list);
+
+  return segmenter;
+}
@@ -0,0 +1,48 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_dict_segmenter_h
+#define _lr_dict_segmenter_h
+
+#include <glib.h>
+#include "lr-segmenter.h"
+
+G_BEGIN_DECLS
+
+#define LR_TYPE_DICT_SEGMENTER (lr_dict_segmenter_get_type ())
+G_DECLARE_FINAL_TYPE (LrDictSegmenter, lr_dict_segmenter, LR, DICT_SEGMENTER, LrSegmenter)
+
+/* Creates a segmenter from the word list of the language, or returns NULL
+ * if there is no word list for it.
+ */
+LrSegmenter *lr_dict_segmenter_new (const gchar *code);
+
+/* Creates a segmenter from the contents of a word list, e.g. the one the
+ * instances of a language were saved with */
+LrSegmenter *lr_dict_segmenter_new_from_word_list (GBytes *word_list);
+
+/* Returns the contents of the word list of the language, or NULL if it
+ * has none */
+GBytes *lr_dict_segmenter_find_word_list (const gchar *code);
+
+/* Returns the version of the segmenter of the word list, without building it */
+guint64 lr_dict_segmenter_hash_word_list (GBytes *word_list);
+
+G_END_DECLS
+
+#endif /* _lr_dict_segmenter_h */
@@ -18,6 +18,8 @@
 
 #include "lr-language-editor-dialog.h"
 #include "language_presets.h"
+#include "lr-char-class.h"
+#include "lr-preset-classes.h"
 
 struct _LrLanguageEditorDialog
 {
@@ -30,10 +32,14 @@ struct _LrLanguageEditorDialog
   GtkWidget *code_entry;
   GtkWidget *regex_entry;
   GtkWidget *sentence_sep_entry;
+  GtkWidget *abbreviations_entry;
 
   GtkWidget *preset_box;
   GtkWidget *preset_listbox;
 
+  /* Whether the word regex compiles, as found by update_regex_hint */
+  gboolean word_regex_valid;
+
   /* 
    * AWFUL HACK:
    * When the user selects a preset, the text of the entries is changed.
@@ -69,6 +75,66 @@ preset_edited (LrLanguageEditorDialog *self, GtkWidget *entry)
     gtk_list_box_unselect_all (GTK_LIST_BOX (self->preset_listbox));
 }
 
+/* Only languages whose regexes compile can be saved */
+static void
+update_ok_sensitivity (LrLanguageEditorDialog *self)
+{
+  const gchar *separator_regex = gtk_entry_get_text (GTK_ENTRY (self->sentence_sep_entry));
+  GRegex *compiled = g_regex_new (separator_regex, 0, 0, NULL);
+  gboolean separator_regex_valid = compiled != NULL;
+  g_clear_pointer (&compiled, g_regex_unref);
+
+  gtk_dialog_set_response_sensitive (
+    GTK_DIALOG (self), GTK_RESPONSE_OK, self->word_regex_valid && separator_regex_valid);
+}
+
+/* Tells the user how the word regex is going to be matched */
+static void
+update_regex_hint (LrLanguageEditorDialog *self)
+{
+  GtkEntry *entry = GTK_ENTRY (self->regex_entry);
+  const gchar *regex = gtk_entry_get_text (entry);
+
+  const gchar *icon = "emblem-ok-symbolic";
+  gchar *tooltip = NULL;
+  self->word_regex_valid = TRUE;
+
+  lr_char_class_t *klass = NULL;
+  if (lr_preset_class_lookup (regex))
+    {
+      tooltip = g_strdup ("Built-in character class of a preset");
+    }
+  else if ((klass = lr_char_class_new_from_regex (regex)))
+    {
+      tooltip = g_strdup ("Character class, matched without the regex engine");
+      lr_char_class_free (klass);
+    }
+  else
+    {
+      GError *error = NULL;
+      GRegex *compiled = g_regex_new (regex, 0, 0, &error);
+      if (compiled)
+        {
+          icon = "system-run-symbolic";
+          tooltip = g_strdup ("Regular expression, matched with the regex engine");
+          g_regex_unref (compiled);
+        }
+      else
+        {
+          icon = "dialog-error-symbolic";
+          tooltip = g_strdup (error->message);
+          g_error_free (error);
+          self->word_regex_valid = FALSE;
+        }
+    }
+
+  gtk_entry_set_icon_from_icon_name (entry, GTK_ENTRY_ICON_SECONDARY, icon);
+  gtk_entry_set_icon_tooltip_text (entry, GTK_ENTRY_ICON_SECONDARY, tooltip);
+  g_free (tooltip);
+
+  update_ok_sensitivity (self);
+}
+
 static void
 preset_picked (LrLanguageEditorDialog *self, GtkWidget *listbox)
 {
@@ -80,11 +146,12 @@ preset_picked (LrLanguageEditorDialog *self, GtkWidget *listbox)
 
   lr_language_preset_t *preset = &presets[index];
 
-  self->skip_unselect_all = 3;
+  self->skip_unselect_all = 4;
   gtk_entry_set_text (GTK_ENTRY (self->name_entry), preset->name);
   gtk_entry_set_text (GTK_ENTRY (self->code_entry), preset->code);
   gtk_entry_set_text (GTK_ENTRY (self->regex_entry), preset->regex);
   gtk_entry_set_text (GTK_ENTRY (self->sentence_sep_entry), preset->separator_regex);
+  gtk_entry_set_text (GTK_ENTRY (self->abbreviations_entry), preset->abbreviations);
 }
 
 static void
@@ -100,6 +167,8 @@ dialog_response (GtkDialog *dialog, int response_id)
                                   gtk_entry_get_text (GTK_ENTRY (self->regex_entry)));
       lr_language_set_separator_regex (self->language,
                                        gtk_entry_get_text (GTK_ENTRY (self->sentence_sep_entry)));
+      lr_language_set_abbreviations (self->language,
+                                     gtk_entry_get_text (GTK_ENTRY (self->abbreviations_entry)));
     }
 }
 
@@ -107,6 +176,7 @@ static void
 lr_language_editor_dialog_init (LrLanguageEditorDialog *self)
 {
   self->skip_unselect_all = 0;
+  self->word_regex_valid = TRUE;
 
   gtk_dialog_add_button (GTK_DIALOG (self), "OK", GTK_RESPONSE_OK);
   gtk_dialog_add_button (GTK_DIALOG (self), "Cancel", GTK_RESPONSE_CANCEL);
@@ -123,6 +193,7 @@ lr_language_editor_dialog_init (LrLanguageEditorDialog *self)
   self->code_entry = GTK_WIDGET (gtk_builder_get_object (builder, "code_entry"));
   self->regex_entry = GTK_WIDGET (gtk_builder_get_object (builder, "regex_entry"));
   self->sentence_sep_entry = GTK_WIDGET (gtk_builder_get_object (builder, "sentence_sep_entry"));
+  self->abbreviations_entry = GTK_WIDGET (gtk_builder_get_object (builder, "abbreviations_entry"));
 
   self->preset_box = GTK_WIDGET (gtk_builder_get_object (builder, "preset_box"));
   self->preset_listbox = GTK_WIDGET (gtk_builder_get_object (builder, "preset_listbox"));
@@ -130,7 +201,11 @@ lr_language_editor_dialog_init (LrLanguageEditorDialog *self)
   g_signal_connect_swapped (self->name_entry, "changed", (GCallback)preset_edited, self);
   g_signal_connect_swapped (self->code_entry, "changed", (GCallback)preset_edited, self);
   g_signal_connect_swapped (self->regex_entry, "changed", (GCallback)preset_edited, self);
+  g_signal_connect_swapped (self->regex_entry, "changed", (GCallback)update_regex_hint, self);
   g_signal_connect_swapped (self->sentence_sep_entry, "changed", (GCallback)preset_edited, self);
+  g_signal_connect_swapped (
+    self->sentence_sep_entry, "changed", (GCallback)update_ok_sensitivity, self);
+  g_signal_connect_swapped (self->abbreviations_entry, "changed", (GCallback)preset_edited, self);
 
   g_signal_connect_swapped (
     self->preset_listbox, "selected-rows-changed", (GCallback)preset_picked, self);
@@ -180,10 +255,13 @@ lr_language_editor_dialog_constructed (GObject *object)
                           lr_language_get_word_regex (self->language));
       gtk_entry_set_text (GTK_ENTRY (self->sentence_sep_entry),
                           lr_language_get_separator_regex (self->language));
+      if (lr_language_get_abbreviations (self->language))
+        gtk_entry_set_text (GTK_ENTRY (self->abbreviations_entry),
+                            lr_language_get_abbreviations (self->language));
 
-      /* Disable the presets and editing of the code or word regex */
+      /* Disable the presets and editing of the code. The word regex can
+       * change, the manager remaps the existing instances to it. */
       gtk_widget_set_sensitive (self->code_entry, FALSE);
-      gtk_widget_set_sensitive (self->regex_entry, FALSE);
       gtk_widget_hide (self->preset_box);
     }
   else
@@ -18,6 +18,7 @@
 
 #include "lr-language-manager-dialog.h"
 #include "lr-language-editor-dialog.h"
+#include "lr-remapper.h"
 
 struct _LrLanguageManagerDialog
 {
@@ -33,6 +34,10 @@ struct _LrLanguageManagerDialog
   LrLanguage *selected_language;
 
   GListStore *language_store;
+
+  /* Shown while remapping the instances after a word regex change */
+  GtkWidget *progress_bar;
+  GCancellable *remap_cancellable;
 };
 
 enum
@@ -74,11 +79,82 @@ new_cb (LrLanguageManagerDialog *self, GtkWidget *button)
   g_clear_object (&new_language);
 }
 
+/* The dialog can't be closed while remapping, the job uses the database */
+static void
+set_remapping (LrLanguageManagerDialog *self, gboolean remapping)
+{
+  gtk_dialog_set_response_sensitive (GTK_DIALOG (self), GTK_RESPONSE_CLOSE, !remapping);
+  gtk_window_set_deletable (GTK_WINDOW (self), !remapping);
+  gtk_widget_set_sensitive (self->language_listbox, !remapping);
+  gtk_widget_set_sensitive (self->new_button, !remapping);
+  gtk_widget_set_sensitive (self->edit_button, !remapping && self->selected_language);
+  gtk_widget_set_sensitive (self->delete_button, !remapping && self->selected_language);
+  gtk_widget_set_visible (self->progress_bar, remapping);
+}
+
+/* Escape and the window manager go through delete-event, which would end
+ * gtk_dialog_run while the job is still running */
+static gboolean
+delete_event_cb (LrLanguageManagerDialog *self, GdkEvent *event)
+{
+  return self->remap_cancellable != NULL;
+}
+
+static void
+response_cb (LrLanguageManagerDialog *self, int response_id)
+{
+  if (self->remap_cancellable)
+    g_signal_stop_emission_by_name (self, "response");
+}
+
+static void
+remap_progress_cb (int n_done, int n_texts, gpointer user_data)
+{
+  LrLanguageManagerDialog *self = LR_LANGUAGE_MANAGER_DIALOG (user_data);
+
+  /* The widgets are gone once the dialog is disposed */
+  if (!self->remap_cancellable || g_cancellable_is_cancelled (self->remap_cancellable))
+    return;
+
+  gchar *text = g_strdup_printf ("Updating the vocabulary of %d/%d texts", n_done, n_texts);
+  gtk_progress_bar_set_text (GTK_PROGRESS_BAR (self->progress_bar), text);
+  gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (self->progress_bar),
+                                 n_texts ? (gdouble)n_done / n_texts : 0.0);
+  g_free (text);
+}
+
+static void
+remap_done_cb (LrDatabase *db, GAsyncResult *result, gpointer user_data)
+{
+  LrLanguageManagerDialog *self = LR_LANGUAGE_MANAGER_DIALOG (user_data);
+  GError *error = NULL;
+
+  if (lr_remap_language_finish (db, result, &error) < 0)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to update the vocabulary: %s", error->message);
+      g_error_free (error);
+    }
+
+  gboolean cancelled = g_cancellable_is_cancelled (self->remap_cancellable);
+  g_clear_object (&self->remap_cancellable);
+
+  if (!cancelled)
+    {
+      set_remapping (self, FALSE);
+      populate_languages (self);
+    }
+
+  /* Held by the job */
+  g_object_unref (self);
+}
+
 static void
 edit_cb (LrLanguageManagerDialog *self, GtkWidget *button)
 {
   g_assert (LR_IS_LANGUAGE (self->selected_language));
   GtkWidget *dialog = lr_language_editor_dialog_new (self->selected_language, TRUE);
+  gchar *old_word_regex = g_strdup (lr_language_get_word_regex (self->selected_language));
 
   gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (self));
 
@@ -88,9 +164,35 @@ edit_cb (LrLanguageManagerDialog *self, GtkWidget *button)
 
   if (response == GTK_RESPONSE_OK)
     {
-      lr_database_update_language (self->db, self->selected_language);
-      populate_languages (self);
+      gchar *new_word_regex = g_strdup (lr_language_get_word_regex (self->selected_language));
+
+      if (g_strcmp0 (old_word_regex, new_word_regex) != 0)
+        {
+          /* The word indices of the instances refer to the old words, so
+           * the new regex is only saved along with the remapped instances */
+          lr_language_set_word_regex (self->selected_language, old_word_regex);
+          lr_database_update_language (self->db, self->selected_language);
+
+          self->remap_cancellable = g_cancellable_new ();
+          remap_progress_cb (0, 0, self);
+          set_remapping (self, TRUE);
+          lr_remap_language_async (self->db,
+                                   self->selected_language,
+                                   new_word_regex,
+                                   self->remap_cancellable,
+                                   remap_progress_cb,
+                                   self,
+                                   (GAsyncReadyCallback)remap_done_cb,
+                                   g_object_ref (self));
+        }
+      else
+        {
+          lr_database_update_language (self->db, self->selected_language);
+          populate_languages (self);
+        }
+      g_free (new_word_regex);
     }
+  g_free (old_word_regex);
 }
 
 static void
@@ -163,6 +265,11 @@ lr_language_manager_dialog_init (LrLanguageManagerDialog *self)
   GtkWidget *root_box = GTK_WIDGET (gtk_builder_get_object (builder, "box"));
   gtk_container_add (GTK_CONTAINER (box), root_box);
 
+  self->progress_bar = gtk_progress_bar_new ();
+  gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (self->progress_bar), TRUE);
+  gtk_widget_set_no_show_all (self->progress_bar, TRUE);
+  gtk_box_pack_end (GTK_BOX (box), self->progress_bar, FALSE, FALSE, 6);
+
   self->language_listbox = GTK_WIDGET (gtk_builder_get_object (builder, "language_listbox"));
 
   self->new_button = GTK_WIDGET (gtk_builder_get_object (builder, "new_button"));
@@ -176,6 +283,10 @@ lr_language_manager_dialog_init (LrLanguageManagerDialog *self)
   g_signal_connect_swapped (
     self->language_listbox, "selected-rows-changed", (GCallback)selection_changed_cb, self);
 
+  /* Connected before gtk_dialog_run's own handlers, so they can stop them */
+  g_signal_connect (self, "delete-event", (GCallback)delete_event_cb, NULL);
+  g_signal_connect (self, "response", (GCallback)response_cb, NULL);
+
   g_object_unref (builder);
 }
 
@@ -222,12 +333,26 @@ lr_language_manager_dialog_constructed (GObject *object)
   G_OBJECT_CLASS (lr_language_manager_dialog_parent_class)->constructed (object);
 }
 
+static void
+lr_language_manager_dialog_dispose (GObject *object)
+{
+  LrLanguageManagerDialog *self = LR_LANGUAGE_MANAGER_DIALOG (object);
+
+  /* Nothing is saved by a cancelled job, and its callbacks leave the
+   * widgets alone */
+  if (self->remap_cancellable)
+    g_cancellable_cancel (self->remap_cancellable);
+
+  G_OBJECT_CLASS (lr_language_manager_dialog_parent_class)->dispose (object);
+}
+
 static void
 lr_language_manager_dialog_finalize (GObject *object)
 {
   LrLanguageManagerDialog *self = LR_LANGUAGE_MANAGER_DIALOG (object);
 
   g_clear_object (&self->language_store);
+  g_clear_object (&self->remap_cancellable);
 
   G_OBJECT_CLASS (lr_language_manager_dialog_parent_class)->finalize (object);
 }
@@ -254,6 +379,7 @@ static void
 lr_language_manager_dialog_class_init (LrLanguageManagerDialogClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->dispose = lr_language_manager_dialog_dispose;
   object_class->finalize = lr_language_manager_dialog_finalize;
   object_class->set_property = lr_language_manager_dialog_set_property;
   object_class->constructed = lr_language_manager_dialog_constructed;
@@ -27,6 +27,7 @@ struct _LrLanguage
   gchar *name;
   gchar *word_regex;
   gchar *separator_regex;
+  gchar *abbreviations;
 };
 
 G_DEFINE_TYPE (LrLanguage, lr_language, G_TYPE_OBJECT)
@@ -39,6 +40,7 @@ enum
   PROP_NAME,
   PROP_WORD_REGEX,
   PROP_SEPARATOR_REGEX,
+  PROP_ABBREVIATIONS,
   N_PROPERTIES
 };
 
@@ -60,6 +62,7 @@ lr_language_finalize (GObject *obj)
   g_free (self->name);
   g_free (self->word_regex);
   g_free (self->separator_regex);
+  g_free (self->abbreviations);
 
   G_OBJECT_CLASS (lr_language_parent_class)->finalize (obj);
 }
@@ -89,6 +92,9 @@ lr_language_set_property (GObject *object,
     case PROP_SEPARATOR_REGEX:
       lr_language_set_separator_regex (self, g_value_get_string (value));
       break;
+    case PROP_ABBREVIATIONS:
+      lr_language_set_abbreviations (self, g_value_get_string (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -128,6 +134,13 @@ lr_language_class_init (LrLanguageClass *klass)
                          "",
                          G_PARAM_WRITABLE | G_PARAM_WRITABLE);
 
+  obj_properties[PROP_ABBREVIATIONS] =
+    g_param_spec_string ("abbreviations",
+                         "Abbreviations",
+                         "Space separated abbreviations that do not end a sentence.",
+                         "",
+                         G_PARAM_WRITABLE);
+
   g_object_class_install_properties (object_class, N_PROPERTIES, obj_properties);
 }
 
@@ -216,3 +229,15 @@ lr_language_get_separator_regex (LrLanguage *self)
   return self->separator_regex;
 }
 
+void
+lr_language_set_abbreviations (LrLanguage *self, const gchar *abbreviations)
+{
+  g_free (self->abbreviations);
+  self->abbreviations = g_strdup (abbreviations);
+}
+
+const gchar *
+lr_language_get_abbreviations (LrLanguage *self)
+{
+  return self->abbreviations;
+}
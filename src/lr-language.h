@@ -48,6 +48,14 @@ const gchar *lr_language_get_word_regex (LrLanguage *self);
 void lr_language_set_separator_regex (LrLanguage *self, const gchar *separator_regex);
 const gchar *lr_language_get_separator_regex (LrLanguage *self);
 
+/* A space separated list of abbreviations, including their final period
+ * (e.g. "etc. Dr."), after which a period does not end a sentence. When
+ * this is set, sentences are split by the sentence detector instead of the
+ * separator regex.
+ */
+void lr_language_set_abbreviations (LrLanguage *self, const gchar *abbreviations);
+const gchar *lr_language_get_abbreviations (LrLanguage *self);
+
 G_END_DECLS
 
 #endif /* _lr_language_h */
@@ -25,8 +25,9 @@ struct _LrLemmaInstance
   int id;
   int lemma_id;
   LrText *text;
-  gchar *words;
+  GBytes *words;
   gchar *note;
+  gboolean stale;
 };
 
 enum
@@ -37,6 +38,7 @@ enum
   PROP_TEXT,
   PROP_WORDS,
   PROP_NOTE,
+  PROP_STALE,
   N_PROPERTIES
 };
 
@@ -57,7 +59,7 @@ lr_lemma_instance_finalize (GObject *object)
 {
   LrLemmaInstance *self = LR_LEMMA_INSTANCE (object);
 
-  g_free (self->words);
+  g_clear_pointer (&self->words, g_bytes_unref);
   g_free (self->note);
 
   G_OBJECT_CLASS (lr_lemma_instance_parent_class)->finalize (object);
@@ -83,11 +85,14 @@ lr_lemma_instance_set_property (GObject *object,
       lr_lemma_instance_set_text (self, g_value_get_object (value));
       break;
     case PROP_WORDS:
-      lr_lemma_instance_set_words (self, g_value_get_string (value));
+      lr_lemma_instance_set_words (self, g_value_get_boxed (value));
       break;
     case PROP_NOTE:
       lr_lemma_instance_set_note (self, g_value_get_string (value));
       break;
+    case PROP_STALE:
+      lr_lemma_instance_set_stale (self, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -113,11 +118,14 @@ lr_lemma_instance_get_property (GObject *object,
       g_value_set_object (value, lr_lemma_instance_get_text (self));
       break;
     case PROP_WORDS:
-      g_value_set_string (value, lr_lemma_instance_get_words (self));
+      g_value_set_boxed (value, lr_lemma_instance_get_words (self));
       break;
     case PROP_NOTE:
       g_value_set_string (value, lr_lemma_instance_get_note (self));
       break;
+    case PROP_STALE:
+      g_value_set_boolean (value, lr_lemma_instance_get_stale (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -138,15 +146,17 @@ lr_lemma_instance_class_init (LrLemmaInstanceClass *klass)
   obj_properties[PROP_TEXT] =
     g_param_spec_object ("text", "text", "The text", LR_TYPE_TEXT, G_PARAM_READWRITE);
   obj_properties[PROP_WORDS] =
-    g_param_spec_string ("words", "words", "The words", "", G_PARAM_READWRITE);
+    g_param_spec_boxed ("words", "words", "The encoded words", G_TYPE_BYTES, G_PARAM_READWRITE);
   obj_properties[PROP_NOTE] =
     g_param_spec_string ("note", "note", "The note", "", G_PARAM_READWRITE);
+  obj_properties[PROP_STALE] = g_param_spec_boolean (
+    "stale", "stale", "Whether words were deleted by an edit", FALSE, G_PARAM_READWRITE);
 
   g_object_class_install_properties (object_class, N_PROPERTIES, obj_properties);
 }
 
 LrLemmaInstance *
-lr_lemma_instance_new (int id, int lemma_id, LrText *text, const gchar *words, const gchar *note)
+lr_lemma_instance_new (int id, int lemma_id, LrText *text, GBytes *words, const gchar *note)
 {
   return g_object_new (LR_TYPE_LEMMA_INSTANCE,
                        "id",
@@ -199,13 +209,15 @@ lr_lemma_instance_get_text (LrLemmaInstance *self)
 }
 
 void
-lr_lemma_instance_set_words (LrLemmaInstance *self, const gchar *words)
+lr_lemma_instance_set_words (LrLemmaInstance *self, GBytes *words)
 {
-  g_free (self->words);
-  self->words = g_strdup (words);
+  if (words)
+    g_bytes_ref (words);
+  g_clear_pointer (&self->words, g_bytes_unref);
+  self->words = words;
 }
 
-const gchar *
+GBytes *
 lr_lemma_instance_get_words (LrLemmaInstance *self)
 {
   return self->words;
@@ -224,3 +236,14 @@ lr_lemma_instance_get_note (LrLemmaInstance *self)
   return self->note;
 }
 
+void
+lr_lemma_instance_set_stale (LrLemmaInstance *self, gboolean stale)
+{
+  self->stale = stale;
+}
+
+gboolean
+lr_lemma_instance_get_stale (LrLemmaInstance *self)
+{
+  return self->stale;
+}
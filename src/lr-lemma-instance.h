@@ -40,7 +40,7 @@ G_DECLARE_FINAL_TYPE (LrLemmaInstance, lr_lemma_instance, LR, LEMMA_INSTANCE, GO
  */
 
 LrLemmaInstance *
-lr_lemma_instance_new (int id, int lemma_id, LrText *text, const gchar *words, const gchar *note);
+lr_lemma_instance_new (int id, int lemma_id, LrText *text, GBytes *words, const gchar *note);
 
 void lr_lemma_instance_set_id (LrLemmaInstance *self, int id);
 int lr_lemma_instance_get_id (LrLemmaInstance *self);
@@ -51,12 +51,17 @@ int lr_lemma_instance_get_lemma_id (LrLemmaInstance *self);
 void lr_lemma_instance_set_text (LrLemmaInstance *self, LrText *text);
 LrText *lr_lemma_instance_get_text (LrLemmaInstance *self);
 
-void lr_lemma_instance_set_words (LrLemmaInstance *self, const gchar *words);
-const gchar *lr_lemma_instance_get_words (LrLemmaInstance *self);
+/* The words are encoded as described in lr-word-list.h */
+void lr_lemma_instance_set_words (LrLemmaInstance *self, GBytes *words);
+GBytes *lr_lemma_instance_get_words (LrLemmaInstance *self);
 
 void lr_lemma_instance_set_note (LrLemmaInstance *self, const gchar *note);
 const gchar *lr_lemma_instance_get_note (LrLemmaInstance *self);
 
+/* Set when editing the text deleted some of the words of the instance */
+void lr_lemma_instance_set_stale (LrLemmaInstance *self, gboolean stale);
+gboolean lr_lemma_instance_get_stale (LrLemmaInstance *self);
+
 G_END_DECLS
 
 #endif /* _lr_lemma_instance_h */
@@ -17,6 +17,8 @@
  */
 
 #include "lr-lemmatizer.h"
+#include "lr-lemma-suggestion.h"
+#include "lr-splitter.h"
 
 G_DEFINE_TYPE (LrLemmatizer, lr_lemmatizer, G_TYPE_OBJECT)
 
@@ -30,7 +32,7 @@ static gchar *
 base_lemmatizer_suggestions (LrLemmatizer *self,
                              GListStore *store,
                              const char *text,
-                             GList *selection)
+                             GArray *selection)
 {
   return g_strdup ("No lemma suggestions\navailable for this language.");
   return NULL;
@@ -46,13 +48,106 @@ gchar *
 lr_lemmatizer_populate_suggestions (LrLemmatizer *self,
                                     GListStore *store,
                                     const char *text,
-                                    GList *selection)
+                                    GArray *selection)
 {
   g_list_store_remove_all (store);
 
   return LR_LEMMATIZER_GET_CLASS (self)->populate_suggestions (self, store, text, selection);
 }
 
+typedef struct
+{
+  /* The selected words one after the other, and their ranges in it */
+  gchar *text;
+  GArray *selection;
+
+  GListStore *store;
+  gchar *message;
+} lookup_t;
+
+static void
+lookup_free (lookup_t *lookup)
+{
+  g_free (lookup->text);
+  g_array_free (lookup->selection, TRUE);
+  g_clear_object (&lookup->store);
+  g_free (lookup->message);
+  g_free (lookup);
+}
+
+static void
+lookup_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+  LrLemmatizer *self = LR_LEMMATIZER (source_object);
+  lookup_t *lookup = task_data;
+
+  /* Don't bother with lookups that were replaced while waiting */
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  /* The store is private to the task until it is finished */
+  lookup->store = g_list_store_new (LR_TYPE_LEMMA_SUGGESTION);
+  lookup->message =
+    lr_lemmatizer_populate_suggestions (self, lookup->store, lookup->text, lookup->selection);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+void
+lr_lemmatizer_populate_suggestions_async (LrLemmatizer *self,
+                                          const char *text,
+                                          GArray *selection,
+                                          GCancellable *cancellable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data)
+{
+  g_assert (LR_IS_LEMMATIZER (self));
+
+  /* Copy only the selected words, rather than the whole text */
+  lookup_t *lookup = g_new0 (lookup_t, 1);
+  lookup->selection = g_array_sized_new (FALSE, FALSE, sizeof (lr_range_t), selection->len);
+  GString *words = g_string_new (NULL);
+  for (guint i = 0; i < selection->len; i++)
+    {
+      const lr_range_t *range = &g_array_index (selection, lr_range_t, i);
+      lr_range_t copy = { .start = words->len, .end = words->len + (range->end - range->start) };
+
+      g_string_append_len (words, text + range->start, range->end - range->start);
+      g_array_append_val (lookup->selection, copy);
+    }
+  lookup->text = g_string_free (words, FALSE);
+
+  GTask *task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_task_data (task, lookup, (GDestroyNotify)lookup_free);
+  g_task_run_in_thread (task, lookup_thread);
+  g_object_unref (task);
+}
+
+gchar *
+lr_lemmatizer_populate_suggestions_finish (LrLemmatizer *self,
+                                           GAsyncResult *result,
+                                           GListStore *store,
+                                           GError **error)
+{
+  g_assert (g_task_is_valid (result, self));
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return NULL;
+
+  lookup_t *lookup = g_task_get_task_data (G_TASK (result));
+
+  g_list_store_remove_all (store);
+  guint n_items = g_list_model_get_n_items (G_LIST_MODEL (lookup->store));
+  for (guint i = 0; i < n_items; i++)
+    {
+      GObject *item = g_list_model_get_item (G_LIST_MODEL (lookup->store), i);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  return lookup->message ? g_steal_pointer (&lookup->message) : g_strdup ("");
+}
+
 #include "lr-db-lemmatizer.h"
 
 LrLemmatizer *
@@ -35,18 +35,37 @@ struct _LrLemmatizerClass
   gchar *(*populate_suggestions) (LrLemmatizer *self,
                                   GListStore *store,
                                   const char *text,
-                                  GList *selection);
+                                  GArray *selection);
 
   /* No need to add padding since this class is not exposed through an ABI */
 };
 
 /* Populate the given GListStore with suggestions, and possible return a
- * message to be displayed to the user.
+ * message to be displayed to the user. The selection is a GArray of the
+ * lr_range_t's of the selected words.
  */
 gchar *lr_lemmatizer_populate_suggestions (LrLemmatizer *self,
                                            GListStore *store,
                                            const char *text,
-                                           GList *selection);
+                                           GArray *selection);
+
+/* Looks up the suggestions on a worker thread. The selected words are
+ * copied, so the text may change meanwhile. Lookups can be cancelled,
+ * which lets a newer selection replace a stale one.
+ */
+void lr_lemmatizer_populate_suggestions_async (LrLemmatizer *self,
+                                               const char *text,
+                                               GArray *selection,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+
+/* Replaces the contents of the store with the suggestions that were found,
+ * and returns the message, or NULL on error (including cancellation). */
+gchar *lr_lemmatizer_populate_suggestions_finish (LrLemmatizer *self,
+                                                  GAsyncResult *result,
+                                                  GListStore *store,
+                                                  GError **error);
 
 LrLemmatizer *lr_lemmatizer_new_for_language (const gchar *code);
 
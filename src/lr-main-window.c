@@ -22,6 +22,7 @@
 #include "lr-language-editor-dialog.h"
 #include "lr-language-manager-dialog.h"
 #include "lr-reader.h"
+#include "lr-remapper.h"
 #include "lr-text-selector.h"
 #include "lr-vocabulary-view.h"
 
@@ -44,6 +45,7 @@ struct _LrMainWindow
   GtkWidget *text_title_label;
 
   GtkWidget *home_switcher;
+  GtkWidget *manage_languages_button;
 
   GtkWidget *text_selector;
   GtkWidget *vocabulary_view;
@@ -239,7 +241,9 @@ read_text_cb (LrTextSelector *selector, LrText *text, LrMainWindow *self)
   g_assert (LR_IS_TEXT (text));
   g_assert (LR_IS_MAIN_WINDOW (self));
 
-  lr_database_load_text (self->db, text);
+  /* Don't reload a text whose contents a cached splitter may refer to */
+  if (lr_text_get_text (text) == NULL)
+    lr_database_load_text (self->db, text);
 
   lr_reader_set_text (LR_READER (self->reader), text, self->db);
 
@@ -327,6 +331,36 @@ text_modified_cb (LrTextSelector *selector, LrMainWindow *self)
   lr_vocabulary_view_set_language (LR_VOCABULARY_VIEW (self->vocabulary_view), self->active_lang);
 }
 
+static void
+set_resegmenting (LrMainWindow *self, gboolean resegmenting)
+{
+  /* The instances can't be added to or remapped until they refer to the
+   * words of the current segmenters */
+  gtk_widget_set_sensitive (self->text_selector, !resegmenting);
+  gtk_widget_set_sensitive (self->manage_languages_button, !resegmenting);
+}
+
+static void
+resegment_done_cb (LrDatabase *db, GAsyncResult *result, gpointer user_data)
+{
+  LrMainWindow *self = LR_MAIN_WINDOW (user_data);
+  GError *error = NULL;
+
+  int n_languages = lr_resegment_languages_finish (db, result, &error);
+  if (n_languages < 0)
+    {
+      g_warning ("Failed to update the vocabulary to the new word lists: %s", error->message);
+      g_error_free (error);
+    }
+
+  set_resegmenting (self, FALSE);
+  if (n_languages > 0 && self->active_lang)
+    lr_vocabulary_view_set_language (LR_VOCABULARY_VIEW (self->vocabulary_view), self->active_lang);
+
+  /* Held by the job */
+  g_object_unref (self);
+}
+
 static void
 lr_main_window_constructed (GObject *obj)
 {
@@ -362,6 +396,11 @@ lr_main_window_constructed (GObject *obj)
   /* Populate the language menu */
   populate_languages (self);
 
+  /* Move the instances of the languages whose word lists were updated */
+  set_resegmenting (self, TRUE);
+  lr_resegment_languages_async (
+    self->db, NULL, (GAsyncReadyCallback)resegment_done_cb, g_object_ref (self));
+
   G_OBJECT_CLASS (lr_main_window_parent_class)->constructed (obj);
 }
 
@@ -434,6 +473,7 @@ lr_main_window_class_init (LrMainWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, LrMainWindow, home_stack);
   gtk_widget_class_bind_template_child (widget_class, LrMainWindow, header_stack);
   gtk_widget_class_bind_template_child (widget_class, LrMainWindow, home_switcher);
+  gtk_widget_class_bind_template_child (widget_class, LrMainWindow, manage_languages_button);
   gtk_widget_class_bind_template_child (widget_class, LrMainWindow, text_title_label);
 
   gtk_widget_class_bind_template_callback (widget_class, about_cb);
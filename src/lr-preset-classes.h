@@ -0,0 +1,39 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_preset_classes_h
+#define _lr_preset_classes_h
+
+#include <glib.h>
+#include "lr-char-class.h"
+
+G_BEGIN_DECLS
+
+/*
+ * The character classes of the word regexes of the language presets,
+ * compiled into tables at build time by gen-preset-classes.
+ */
+
+/* Returns the class of the preset whose word regex is exactly regex, or
+ * NULL if there is none. The class is static and must not be freed.
+ */
+const lr_char_class_t *lr_preset_class_lookup (const gchar *regex);
+
+G_END_DECLS
+
+#endif /* _lr_preset_classes_h */
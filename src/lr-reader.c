@@ -19,6 +19,7 @@
 #include "lr-reader.h"
 #include "lr-dictionary.h"
 #include "lr-splitter.h"
+#include "lr-splitter-cache.h"
 #include "lr-lemmatizer.h"
 #include "lr-lemma-suggestion.h"
 #include "lr-lemma.h"
@@ -27,8 +28,8 @@
 
 typedef struct
 {
-  /* List of lr_range_t* */
-  GList *words;
+  /* Array of word indices */
+  GArray *words;
   LrLemmaInstance *instance;
 } instance_range_t;
 
@@ -56,15 +57,27 @@ struct _LrReader
 
   GtkTextTag *selection_tag;
   GtkTextTag *instance_tag;
+  GtkTextTag *stale_instance_tag;
   GtkTextTag *highlighted_instance_tag;
 
-  /* A list of lr_range_t's */
-  GList *selection;
+  /* An array of word indices, in the order they were selected, and the
+   * same words as a bitset of all the words of the text */
+  GArray *selection;
+  guint32 *selection_bits;
+
+  /* The words carrying the selection tag, so that a change of the
+   * selection only touches the words that entered or left it */
+  GArray *tagged_selection;
+  guint32 *tagged_selection_bits;
+
+  /* The instance carrying the highlighted instance tag */
+  instance_range_t *highlighted_instance;
 
   instance_range_t *selected_instance;
   LrLemma *active_lemma;
 
   GListStore *suggestions;
+  GCancellable *suggestions_cancellable;
   GtkWidget *suggestion_listbox;
   GtkWidget *suggestion_scrolled_window;
 
@@ -72,6 +85,11 @@ struct _LrReader
 
   /* A list of instance_range_t */
   GList *instance_ranges;
+
+  /* The instances covering each word, as a GSList of instance_range_t
+   * (usually empty or of one element), the latest one first */
+  GSList **word_instances;
+  int n_indexed_words;
 };
 
 G_DEFINE_TYPE (LrReader, lr_reader, GTK_TYPE_BOX)
@@ -79,24 +97,72 @@ G_DEFINE_TYPE (LrReader, lr_reader, GTK_TYPE_BOX)
 static void
 free_instance_range (instance_range_t *range)
 {
-  g_list_free (range->words);
+  g_array_free (range->words, TRUE);
+  g_object_unref (range->instance);
   g_free (range);
 }
 
-/**
- * Returns whether a given UTF-8 index is within any of the
- * words in the given list.
- */
-static gboolean
-is_index_in_words (GList *words, const lr_range_t *word)
+/* Bitsets of the words of the text */
+
+static guint32 *
+word_bits_new (int n_words)
+{
+  return g_new0 (guint32, (n_words + 31) / 32);
+}
+
+static inline gboolean
+word_bits_get (const guint32 *bits, int word)
+{
+  return (bits[word / 32] >> (word % 32)) & 1;
+}
+
+static inline void
+word_bits_set (guint32 *bits, int word, gboolean value)
+{
+  if (value)
+    bits[word / 32] |= 1u << (word % 32);
+  else
+    bits[word / 32] &= ~(1u << (word % 32));
+}
+
+static void
+index_instance (LrReader *self, instance_range_t *range)
+{
+  for (guint i = 0; i < range->words->len; i++)
+    {
+      int word = g_array_index (range->words, int, i);
+      if (word >= 0 && word < self->n_indexed_words)
+        self->word_instances[word] = g_slist_prepend (self->word_instances[word], range);
+    }
+}
+
+static void
+unindex_instance (LrReader *self, instance_range_t *range)
 {
-  for (GList *l = words; l != NULL; l = l->next)
+  for (guint i = 0; i < range->words->len; i++)
     {
-      const lr_range_t *range = l->data;
-      if (word == range)
-        return TRUE;
+      int word = g_array_index (range->words, int, i);
+      if (word >= 0 && word < self->n_indexed_words)
+        self->word_instances[word] = g_slist_remove (self->word_instances[word], range);
     }
-  return FALSE;
+}
+
+static void
+clear_instance_index (LrReader *self)
+{
+  for (int i = 0; i < self->n_indexed_words; i++)
+    g_slist_free (self->word_instances[i]);
+  g_clear_pointer (&self->word_instances, g_free);
+  self->n_indexed_words = 0;
+}
+
+/* Returns the latest instance covering the word, or NULL */
+static instance_range_t *
+instance_at_word (LrReader *self, int word)
+{
+  if (word < 0 || word >= self->n_indexed_words || !self->word_instances[word])
+    return NULL;
+  return self->word_instances[word]->data;
 }
 
 static void selection_changed (LrReader *self);
@@ -104,65 +170,177 @@ static void selection_changed (LrReader *self);
 static void
 clear_selection (LrReader *self)
 {
-  g_list_free (self->selection);
-  self->selection = NULL;
+  for (guint i = 0; i < self->selection->len; i++)
+    word_bits_set (self->selection_bits, g_array_index (self->selection, int, i), FALSE);
+  g_array_set_size (self->selection, 0);
   self->selected_instance = NULL;
 }
 
 static void
-apply_tag_to_word (LrReader *self, const lr_range_t *range, GtkTextTag *tag)
+set_tag_on_word (LrReader *self, int word, GtkTextTag *tag, gboolean set)
 {
-  const gchar *text = lr_text_get_text (self->text);
   GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview));
 
-  /* Convert the byte indices to character offsets */
-  int start_offset = g_utf8_pointer_to_offset (text, &text[range->start]);
-  int end_offset = g_utf8_pointer_to_offset (text, &text[range->end]);
+  lr_range_t range;
+  lr_splitter_get_word_chars (self->splitter, word, &range);
 
   GtkTextIter word_start, word_end;
-  gtk_text_buffer_get_iter_at_offset (buffer, &word_start, start_offset);
-  gtk_text_buffer_get_iter_at_offset (buffer, &word_end, end_offset);
+  gtk_text_buffer_get_iter_at_offset (buffer, &word_start, range.start);
+  gtk_text_buffer_get_iter_at_offset (buffer, &word_end, range.end);
+
+  if (set)
+    gtk_text_buffer_apply_tag (buffer, tag, &word_start, &word_end);
+  else
+    gtk_text_buffer_remove_tag (buffer, tag, &word_start, &word_end);
+}
+
+/* Whether only spaces separate the word from the next one, so that a
+ * tag can span both without marking any punctuation */
+static gboolean
+is_joined_to_next_word (LrReader *self, int word)
+{
+  if (word + 1 >= lr_splitter_get_n_words (self->splitter))
+    return FALSE;
+
+  lr_range_t range, next;
+  lr_splitter_get_word (self->splitter, word, &range);
+  lr_splitter_get_word (self->splitter, word + 1, &next);
 
-  gtk_text_buffer_apply_tag (buffer, tag, &word_start, &word_end);
+  const gchar *text = lr_text_get_text (self->text);
+  for (int i = range.end; i < next.start; i++)
+    {
+      if (text[i] != ' ')
+        return FALSE;
+    }
+  return TRUE;
 }
 
+/* Applies or removes the tag on the sorted words in one sweep over the buffer,
+ * as spans of consecutive words, moving a single iterator forward between them */
 static void
-apply_selection_tag (LrReader *self)
+set_tag_on_sorted_words (LrReader *self, GArray *words, GtkTextTag *tag, gboolean set)
 {
   GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview));
 
-  /* Remove all previously applied instances of the selection tag */
-  GtkTextIter start, end;
-  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  GtkTextIter iter;
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  int offset = 0;
+
+  guint i = 0;
+  while (i < words->len)
+    {
+      int first = g_array_index (words, int, i);
+      int last = first;
+
+      /* Extend the span over the following words, skipping duplicates */
+      for (i++; i < words->len; i++)
+        {
+          int word = g_array_index (words, int, i);
+          if (word == last)
+            continue;
+          if (word != last + 1 || !is_joined_to_next_word (self, last))
+            break;
+          last = word;
+        }
+
+      lr_range_t start, end;
+      lr_splitter_get_word_chars (self->splitter, first, &start);
+      lr_splitter_get_word_chars (self->splitter, last, &end);
+
+      gtk_text_iter_forward_chars (&iter, start.start - offset);
+      GtkTextIter span_end = iter;
+      gtk_text_iter_forward_chars (&span_end, end.end - start.start);
+
+      if (set)
+        gtk_text_buffer_apply_tag (buffer, tag, &iter, &span_end);
+      else
+        gtk_text_buffer_remove_tag (buffer, tag, &iter, &span_end);
+
+      iter = span_end;
+      offset = end.end;
+    }
+}
 
-  gtk_text_buffer_remove_tag (buffer, self->selection_tag, &start, &end);
+static int
+compare_words (gconstpointer a, gconstpointer b)
+{
+  return *(const int *)a - *(const int *)b;
+}
 
-  /* Apply the tag for each selected word */
-  for (GList *l = self->selection; l != NULL; l = l->next)
+static void
+apply_selection_tag (LrReader *self)
+{
+  /* Untag the words that left the selection */
+  for (guint i = 0; i < self->tagged_selection->len; i++)
     {
-      const lr_range_t *range = (const lr_range_t *)l->data;
-      apply_tag_to_word (self, range, self->selection_tag);
+      int word = g_array_index (self->tagged_selection, int, i);
+      if (!word_bits_get (self->selection_bits, word))
+        {
+          set_tag_on_word (self, word, self->selection_tag, FALSE);
+          word_bits_set (self->tagged_selection_bits, word, FALSE);
+        }
     }
+
+  /* Tag the words that entered it */
+  for (guint i = 0; i < self->selection->len; i++)
+    {
+      int word = g_array_index (self->selection, int, i);
+      if (!word_bits_get (self->tagged_selection_bits, word))
+        {
+          set_tag_on_word (self, word, self->selection_tag, TRUE);
+          word_bits_set (self->tagged_selection_bits, word, TRUE);
+        }
+    }
+
+  g_array_set_size (self->tagged_selection, 0);
+  g_array_append_vals (self->tagged_selection, self->selection->data, self->selection->len);
 }
 
 static void
 highlight_selected_instance (LrReader *self)
 {
-  GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview));
-
-  GtkTextIter start, end;
-  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  if (self->highlighted_instance == self->selected_instance)
+    return;
 
-  gtk_text_buffer_remove_tag (buffer, self->highlighted_instance_tag, &start, &end);
+  /* Only the words of the previous and the new instance change, and
+   * the words of an instance are sorted */
+  if (self->highlighted_instance)
+    set_tag_on_sorted_words (
+      self, self->highlighted_instance->words, self->highlighted_instance_tag, FALSE);
 
   if (self->selected_instance)
+    set_tag_on_sorted_words (
+      self, self->selected_instance->words, self->highlighted_instance_tag, TRUE);
+
+  self->highlighted_instance = self->selected_instance;
+}
+
+static void
+suggestions_ready_cb (LrLemmatizer *lemmatizer, GAsyncResult *result, LrReader *self)
+{
+  GError *error = NULL;
+  gchar *message = lr_lemmatizer_populate_suggestions_finish (
+    lemmatizer, result, self->suggestions, &error);
+
+  if (message)
     {
-      GList *word_list = self->selected_instance->words;
-      for (GList *l = word_list; l != NULL; l = l->next)
-        {
-          apply_tag_to_word (self, (lr_range_t *)l->data, self->highlighted_instance_tag);
-        }
+      gtk_label_set_text (GTK_LABEL (self->lemmatizer_note_label), message);
+      g_free (message);
+
+      /* If there are no suggestions, hide the list box */
+      int n_suggestions = g_list_model_get_n_items (G_LIST_MODEL (self->suggestions));
+      gtk_widget_set_visible (self->suggestion_scrolled_window, n_suggestions > 0);
     }
+  else
+    {
+      /* Cancelled lookups were replaced by newer ones */
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to look up the lemma suggestions: %s", error->message);
+      g_error_free (error);
+    }
+
+  /* Held by the lookup */
+  g_object_unref (self);
 }
 
 static void
@@ -173,26 +351,35 @@ selection_changed (LrReader *self)
   /* If only a single word is selected, set it as the text
    * of the root form entry, as a heuristic
    */
-  if ((self->selection) && (self->selection->next == NULL))
+  if (self->selection->len == 1)
     {
       /* Only a single word is selected */
-      const lr_range_t *range = self->selection->data;
+      lr_range_t range;
+      lr_splitter_get_word (self->splitter, g_array_index (self->selection, int, 0), &range);
       const gchar *text = lr_text_get_text (self->text);
-      gchar *word = g_strndup (text + range->start, (range->end - range->start));
+      gchar *word = g_strndup (text + range.start, (range.end - range.start));
 
       gtk_entry_set_text (GTK_ENTRY (self->root_form_entry), word);
 
       g_free (word);
     }
 
-  gchar *message = lr_lemmatizer_populate_suggestions (
-    self->lemmatizer, self->suggestions, lr_text_get_text (self->text), self->selection);
-  gtk_label_set_text (GTK_LABEL (self->lemmatizer_note_label), message);
-  g_free (message);
-
-  /* If there are no suggestions, hide the list box */
-  int n_suggestions = g_list_model_get_n_items (G_LIST_MODEL (self->suggestions));
-  gtk_widget_set_visible (self->suggestion_scrolled_window, n_suggestions > 0);
+  /* A newer selection replaces the lookup of the previous one */
+  if (self->suggestions_cancellable)
+    {
+      g_cancellable_cancel (self->suggestions_cancellable);
+      g_object_unref (self->suggestions_cancellable);
+    }
+  self->suggestions_cancellable = g_cancellable_new ();
+
+  GArray *ranges = lr_splitter_selection_to_ranges (self->splitter, self->selection);
+  lr_lemmatizer_populate_suggestions_async (self->lemmatizer,
+                                            lr_text_get_text (self->text),
+                                            ranges,
+                                            self->suggestions_cancellable,
+                                            (GAsyncReadyCallback)suggestions_ready_cb,
+                                            g_object_ref (self));
+  g_array_free (ranges, TRUE);
 }
 
 static void
@@ -218,43 +405,112 @@ open_lemma_from_active_instance (LrReader *self)
   gtk_widget_grab_focus (self->translation_entry);
 }
 
+static GtkTextTag *
+tag_of_instance (LrReader *self, instance_range_t *range)
+{
+  return lr_lemma_instance_get_stale (range->instance) ? self->stale_instance_tag
+                                                       : self->instance_tag;
+}
+
+/* Creates the range of the instance and indexes it, without tagging it */
+static instance_range_t *
+add_instance_range (LrReader *self, LrLemmaInstance *instance)
+{
+  instance_range_t *range = g_malloc (sizeof (instance_range_t));
+  range->words =
+    lr_splitter_words_from_bytes (self->splitter, lr_lemma_instance_get_words (instance));
+  g_array_sort (range->words, compare_words);
+  range->instance = g_object_ref (instance);
+
+  self->instance_ranges = g_list_prepend (self->instance_ranges, range);
+  index_instance (self, range);
+
+  return range;
+}
+
+/* Drops the range of the instance and its tags, retagging the instances
+ * that still cover any of its words. They are retagged whole, so that the
+ * spaces their spans took between joined words are tagged again too. */
+static void
+remove_instance_range (LrReader *self, instance_range_t *range)
+{
+  unindex_instance (self, range);
+  self->instance_ranges = g_list_remove (self->instance_ranges, range);
+
+  set_tag_on_sorted_words (self, range->words, tag_of_instance (self, range), FALSE);
+
+  GPtrArray *others = g_ptr_array_new ();
+  for (guint i = 0; i < range->words->len; i++)
+    {
+      int word = g_array_index (range->words, int, i);
+      if (word < 0 || word >= self->n_indexed_words)
+        continue;
+
+      for (GSList *link = self->word_instances[word]; link; link = link->next)
+        {
+          if (!g_ptr_array_find (others, link->data, NULL))
+            g_ptr_array_add (others, link->data);
+        }
+    }
+
+  for (guint i = 0; i < others->len; i++)
+    {
+      instance_range_t *other = g_ptr_array_index (others, i);
+      set_tag_on_sorted_words (self, other->words, tag_of_instance (self, other), TRUE);
+    }
+  g_ptr_array_free (others, TRUE);
+
+  free_instance_range (range);
+}
+
 static void
 update_instances (LrReader *self)
 {
   lr_database_populate_lemma_instances (self->db, self->instance_store, self->text);
 
+  clear_instance_index (self);
   g_list_free_full (self->instance_ranges, (GDestroyNotify)free_instance_range);
   self->instance_ranges = NULL;
 
+  self->n_indexed_words = lr_splitter_get_n_words (self->splitter);
+  self->word_instances = g_new0 (GSList *, self->n_indexed_words);
+
   GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview));
 
   GtkTextIter start, end;
   gtk_text_buffer_get_bounds (buffer, &start, &end);
 
   gtk_text_buffer_remove_tag (buffer, self->instance_tag, &start, &end);
+  gtk_text_buffer_remove_tag (buffer, self->stale_instance_tag, &start, &end);
+
+  /* The tagged words are collected first and applied in one sweep each */
+  GArray *tagged = g_array_new (FALSE, FALSE, sizeof (int));
+  GArray *stale = g_array_new (FALSE, FALSE, sizeof (int));
 
   int n_instances = g_list_model_get_n_items (G_LIST_MODEL (self->instance_store));
   for (int i = 0; i < n_instances; ++i)
     {
       LrLemmaInstance *instance = g_list_model_get_item (G_LIST_MODEL (self->instance_store), i);
 
-      GList *ranges =
-        lr_splitter_ranges_from_string (self->splitter, lr_lemma_instance_get_words (instance));
-
-      instance_range_t *instance_range = g_malloc (sizeof (instance_range_t));
-      instance_range->words = ranges;
-      instance_range->instance = instance;
+      instance_range_t *instance_range = add_instance_range (self, instance);
 
-      self->instance_ranges = g_list_append (self->instance_ranges, instance_range);
+      GArray *words = instance_range->words;
+      GArray *words_of_tag = lr_lemma_instance_get_stale (instance) ? stale : tagged;
+      g_array_append_vals (words_of_tag, words->data, words->len);
 
       g_object_unref (instance);
-
-      for (GList *l = ranges; l != NULL; l = l->next)
-        {
-          const lr_range_t *range = (const lr_range_t *)l->data;
-          apply_tag_to_word (self, range, self->instance_tag);
-        }
     }
+
+  /* The ranges hold the instances from here on, new ones are added to them */
+  g_list_store_remove_all (self->instance_store);
+
+  g_array_sort (tagged, compare_words);
+  g_array_sort (stale, compare_words);
+  set_tag_on_sorted_words (self, tagged, self->instance_tag, TRUE);
+  set_tag_on_sorted_words (self, stale, self->stale_instance_tag, TRUE);
+
+  g_array_free (tagged, TRUE);
+  g_array_free (stale, TRUE);
 }
 
 /* Highlight an instance, open the edit panel and load the lemma.
@@ -287,19 +543,12 @@ lr_reader_button_press_event (GtkWidget *widget, GdkEventButton *event, gpointer
   GtkTextIter click_iter;
   gtk_text_view_get_iter_at_location (GTK_TEXT_VIEW (textview), &click_iter, buff_x, buff_y);
 
-  const char *text = lr_text_get_text (self->text);
-  const char *byte_index = g_utf8_offset_to_pointer (text, gtk_text_iter_get_offset (&click_iter));
-  int index = byte_index - text;
+  int index =
+    lr_splitter_char_to_byte_offset (self->splitter, gtk_text_iter_get_offset (&click_iter));
 
-  const lr_range_t *range = lr_splitter_get_word_at_index (self->splitter, index);
+  int word = lr_splitter_get_word_index_at_offset (self->splitter, index);
 
-  instance_range_t *selected_instance = NULL;
-  for (GList *l = self->instance_ranges; l != NULL; l = l->next)
-    {
-      GList *words = ((instance_range_t *)l->data)->words;
-      if (is_index_in_words (words, range))
-        selected_instance = (instance_range_t *)l->data;
-    }
+  instance_range_t *selected_instance = instance_at_word (self, word);
 
   /* If we clicked on an instance, clear the selection and
    * set that instance as the selected one.
@@ -319,27 +568,21 @@ lr_reader_button_press_event (GtkWidget *widget, GdkEventButton *event, gpointer
         clear_selection (self);
 
       /* If a word was selected, add it to the selection */
-      if (range != NULL)
+      if (word >= 0)
         {
           /* Make sure the word is not already in the selection */
-          gboolean in_selection = FALSE;
-          for (GList *l = self->selection; l != NULL; l = l->next)
+          if (!word_bits_get (self->selection_bits, word))
             {
-              if (l->data == (gpointer)range)
-                {
-                  in_selection = TRUE;
-                  break;
-                }
+              g_array_append_val (self->selection, word);
+              word_bits_set (self->selection_bits, word, TRUE);
             }
-          if (!in_selection)
-            self->selection = g_list_append (self->selection, (gpointer)range);
         }
 
       selection_changed (self);
       highlight_selected_instance (self);
 
       /* Set the stack to the right page */
-      if (self->selection)
+      if (self->selection->len)
         {
           gtk_stack_set_visible_child_name (GTK_STACK (self->word_stack), "new-instance");
         }
@@ -369,40 +612,23 @@ mark_instance_cb (GtkButton *button, LrReader *self)
   LrLemma *lemma = lr_lemma_new (-1, root_form, "", lr_text_get_language (self->text));
   lr_database_load_or_create_lemma (self->db, lemma);
 
-  gchar *words = lr_splitter_selection_to_text (self->splitter, self->selection);
+  GBytes *words = lr_splitter_selection_to_bytes (self->splitter, self->selection);
 
   /* Create a new lemma instance and set its lemma and word fields */
   LrLemmaInstance *instance =
     lr_lemma_instance_new (-1, lr_lemma_get_id (lemma), self->text, words, "");
-  g_free (words);
+  g_bytes_unref (words);
 
   /* Persist it in the database */
   lr_database_insert_instance (self->db, instance);
 
-  int new_id = lr_lemma_instance_get_id (instance);
+  /* Add and tag only the new instance, then select it */
+  instance_range_t *instance_range = add_instance_range (self, instance);
+  set_tag_on_sorted_words (self, instance_range->words, self->instance_tag, TRUE);
 
   g_object_unref (instance);
   g_object_unref (lemma);
 
-  /* Reload the instances */
-  clear_selection (self);
-  update_instances (self);
-
-  /* Select the instance with the new id */
-  instance_range_t *instance_range = NULL;
-
-  for (GList *l = self->instance_ranges; l != NULL; l = l->next)
-    {
-      instance_range_t *ir = (instance_range_t *)l->data;
-      int id = lr_lemma_instance_get_id (ir->instance);
-      if (new_id == id)
-        {
-          instance_range = ir;
-          break;
-        }
-    }
-  g_assert (instance_range != NULL); /* We just added it, it has to be there! */
-
   activate_instance (self, instance_range);
 }
 
@@ -447,7 +673,16 @@ instance_note_changed_cb (GtkEntry *entry, LrReader *self)
   LrLemmaInstance *instance = self->selected_instance->instance;
   g_assert (LR_IS_LEMMA_INSTANCE (instance));
 
+  /* Editing the note of a stale instance counts as reviewing it */
+  if (lr_lemma_instance_get_stale (instance))
+    {
+      GArray *words = self->selected_instance->words;
+      set_tag_on_sorted_words (self, words, self->stale_instance_tag, FALSE);
+      set_tag_on_sorted_words (self, words, self->instance_tag, TRUE);
+    }
+
   lr_lemma_instance_set_note (instance, new_note);
+  lr_lemma_instance_set_stale (instance, FALSE);
   lr_database_update_instance (self->db, instance);
 }
 
@@ -461,10 +696,11 @@ remove_instance_cb (LrReader *self, GtkWidget *button)
 
   /* Close the edit panel and clear the active lemma and instance. */
   g_clear_object (&self->active_lemma);
+  instance_range_t *removed = self->selected_instance;
   self->selected_instance = NULL;
 
-  update_instances (self);
   highlight_selected_instance (self);
+  remove_instance_range (self, removed);
 
   gtk_stack_set_visible_child_name (GTK_STACK (self->word_stack), "no-selection");
 }
@@ -558,7 +794,8 @@ lr_reader_init (LrReader *self)
   g_signal_connect (
     self->textview, "button-press-event", (GCallback)lr_reader_button_press_event, self);
 
-  self->selection = NULL;
+  self->selection = g_array_new (FALSE, FALSE, sizeof (int));
+  self->tagged_selection = g_array_new (FALSE, FALSE, sizeof (int));
 
   self->instance_tag =
     gtk_text_buffer_create_tag (gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview)),
@@ -566,6 +803,14 @@ lr_reader_init (LrReader *self)
                                 "weight",
                                 PANGO_WEIGHT_BOLD,
                                 NULL);
+  self->stale_instance_tag =
+    gtk_text_buffer_create_tag (gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview)),
+                                "stale-instance",
+                                "weight",
+                                PANGO_WEIGHT_BOLD,
+                                "underline",
+                                PANGO_UNDERLINE_ERROR,
+                                NULL);
   self->selection_tag =
     gtk_text_buffer_create_tag (gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview)),
                                 "selection",
@@ -600,18 +845,38 @@ lr_reader_init (LrReader *self)
   gtk_widget_set_valign (self->dictionary, GTK_ALIGN_END);
 }
 
+static void
+lr_reader_dispose (GObject *obj)
+{
+  LrReader *self = LR_READER (obj);
+
+  /* A pending lookup holds a reference until it finishes, cancel it so
+   * that it does not fill the widgets of a destroyed reader */
+  if (self->suggestions_cancellable)
+    g_cancellable_cancel (self->suggestions_cancellable);
+
+  G_OBJECT_CLASS (lr_reader_parent_class)->dispose (obj);
+}
+
 static void
 lr_reader_finalize (GObject *obj)
 {
   LrReader *self = LR_READER (obj);
 
-  clear_selection (self);
+  g_array_free (self->selection, TRUE);
+  g_array_free (self->tagged_selection, TRUE);
+  g_free (self->selection_bits);
+  g_free (self->tagged_selection_bits);
 
+  clear_instance_index (self);
   g_list_free_full (self->instance_ranges, (GDestroyNotify)free_instance_range);
 
+  g_clear_object (&self->suggestions_cancellable);
   g_clear_object (&self->suggestions);
   g_clear_object (&self->instance_store);
   g_clear_object (&self->active_lemma);
+  g_clear_object (&self->splitter);
+  g_clear_object (&self->text);
 
   G_OBJECT_CLASS (lr_reader_parent_class)->finalize (obj);
 }
@@ -620,6 +885,7 @@ static void
 lr_reader_class_init (LrReaderClass *klass)
 {
   GObjectClass *obj_class = G_OBJECT_CLASS (klass);
+  obj_class->dispose = lr_reader_dispose;
   obj_class->finalize = lr_reader_finalize;
 
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
@@ -659,12 +925,16 @@ lr_reader_set_text (LrReader *self, LrText *text, LrDatabase *db)
   g_assert (LR_IS_TEXT (text));
   g_assert (LR_IS_DATABASE (db));
 
+  /* Keep the text alive for as long as its splitter is in use */
+  g_object_ref (text);
+  g_clear_object (&self->text);
   self->text = text;
   self->db = db;
 
-  /* Destroy the old splitter (if any) and create a new one */
+  /* Drop the old splitter (if any) and get the one of the new text, which
+   * is still cached if the text was read recently */
   g_clear_object (&self->splitter);
-  self->splitter = lr_splitter_new (self->text);
+  self->splitter = lr_splitter_cache_lookup (self->text, self->db);
 
   /* Destroy the old lemmatizer (if any) and create a new one */
   g_clear_object (&self->lemmatizer);
@@ -674,6 +944,16 @@ lr_reader_set_text (LrReader *self, LrText *text, LrDatabase *db)
   GtkTextBuffer *text_buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (self->textview));
   gtk_text_buffer_set_text (text_buffer, lr_text_get_text (text), -1);
 
+  /* Setting the text dropped all tags, start over with the words of the new one */
+  int n_words = lr_splitter_get_n_words (self->splitter);
+  g_array_set_size (self->selection, 0);
+  g_array_set_size (self->tagged_selection, 0);
+  g_free (self->selection_bits);
+  g_free (self->tagged_selection_bits);
+  self->selection_bits = word_bits_new (n_words);
+  self->tagged_selection_bits = word_bits_new (n_words);
+  self->highlighted_instance = NULL;
+
   clear_selection (self);
   update_instances (self);
 
@@ -0,0 +1,79 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-regex-cache.h"
+
+G_LOCK_DEFINE_STATIC (cache);
+
+/* Maps language IDs to hash tables mapping patterns to GRegex's */
+static GHashTable *cache = NULL;
+
+GRegex *
+lr_regex_cache_lookup (int language_id, const gchar *pattern)
+{
+  g_assert (pattern != NULL);
+
+  G_LOCK (cache);
+
+  if (!cache)
+    cache = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)g_hash_table_unref);
+
+  GHashTable *regexes = g_hash_table_lookup (cache, GINT_TO_POINTER (language_id));
+  if (!regexes)
+    {
+      regexes =
+        g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_regex_unref);
+      g_hash_table_insert (cache, GINT_TO_POINTER (language_id), regexes);
+    }
+
+  GRegex *regex = g_hash_table_lookup (regexes, pattern);
+  if (!regex)
+    {
+      /* The regexes are matched against whole texts, so optimizing them pays off */
+      GError *error = NULL;
+      regex = g_regex_new (pattern, G_REGEX_OPTIMIZE, 0, &error);
+      if (!regex)
+        {
+          /* Languages saved before their regexes were validated can still have broken ones */
+          g_warning ("Failed to compile the regex '%s': %s", pattern, error->message);
+          g_error_free (error);
+          G_UNLOCK (cache);
+          return NULL;
+        }
+      g_hash_table_insert (regexes, g_strdup (pattern), regex);
+    }
+
+  g_regex_ref (regex);
+
+  G_UNLOCK (cache);
+
+  return regex;
+}
+
+void
+lr_regex_cache_invalidate_language (int language_id)
+{
+  G_LOCK (cache);
+
+  /* Splitters still holding one of the regexes keep their own reference */
+  if (cache)
+    g_hash_table_remove (cache, GINT_TO_POINTER (language_id));
+
+  G_UNLOCK (cache);
+}
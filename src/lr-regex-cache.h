@@ -0,0 +1,43 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_regex_cache_h
+#define _lr_regex_cache_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A process-wide cache of the compiled word and separator regexes of each
+ * language, so that they are compiled (and optimized) only once instead of
+ * every time a text is split. It can be used from any thread.
+ */
+
+/* Returns a new reference to the compiled regex, compiling it on first use.
+ * Returns NULL (with a warning) if the pattern doesn't compile, in which
+ * case the regex matches nothing.
+ */
+GRegex *lr_regex_cache_lookup (int language_id, const gchar *pattern);
+
+/* Drops the regexes of a language, after they have been edited or removed */
+void lr_regex_cache_invalidate_language (int language_id);
+
+G_END_DECLS
+
+#endif /* _lr_regex_cache_h */
@@ -0,0 +1,787 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-remapper.h"
+#include "lr-dict-segmenter.h"
+#include "lr-regex-cache.h"
+#include "lr-splitter-cache.h"
+#include "lr-token-diff.h"
+#include "lr-word-list.h"
+#include <sqlite3.h>
+#include <string.h>
+
+typedef struct
+{
+  int instance_id;
+  GBytes *words;
+
+  /* Some of its words are no longer words, so it moved to others */
+  gboolean stale;
+} remapped_instance_t;
+
+typedef struct
+{
+  gchar *path;
+
+  /* The caller's language, switched to the new regex once it is saved */
+  LrLanguage *language;
+  gchar *new_word_regex;
+
+  /* The language as it is saved, and as it is going to be */
+  LrLanguage *old_language;
+  LrLanguage *new_language;
+
+  /* When resegmenting, the segmenter the instances were saved with, or
+   * NULL if it is gone, and the word list replacing it (NULL for none) */
+  gboolean resegment;
+  LrSegmenter *old_segmenter;
+  GBytes *new_word_list;
+
+  /* The words of all instances of the language as they were read, by
+   * instance ID, and the new words of the ones which change */
+  GHashTable *old_words;
+  GArray *remapped;
+
+  GMainContext *context;
+  lr_remap_progress_func_t progress_func;
+  gpointer progress_data;
+} remap_job_t;
+
+static void
+clear_remapped_instance (remapped_instance_t *instance)
+{
+  g_bytes_unref (instance->words);
+}
+
+static void
+remap_job_free (remap_job_t *job)
+{
+  g_free (job->path);
+  g_object_unref (job->language);
+  g_free (job->new_word_regex);
+  g_object_unref (job->old_language);
+  g_object_unref (job->new_language);
+  g_clear_object (&job->old_segmenter);
+  g_clear_pointer (&job->new_word_list, g_bytes_unref);
+  g_hash_table_unref (job->old_words);
+  g_array_free (job->remapped, TRUE);
+  g_clear_pointer (&job->context, g_main_context_unref);
+  g_free (job);
+}
+
+static remap_job_t *
+remap_job_new (const gchar *path, LrLanguage *language)
+{
+  remap_job_t *job = g_new0 (remap_job_t, 1);
+  job->path = g_strdup (path);
+  job->language = g_object_ref (language);
+  job->old_words =
+    g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)g_bytes_unref);
+  job->remapped = g_array_new (FALSE, FALSE, sizeof (remapped_instance_t));
+  g_array_set_clear_func (job->remapped, (GDestroyNotify)clear_remapped_instance);
+
+  return job;
+}
+
+typedef struct
+{
+  remap_job_t *job;
+  int n_done;
+  int n_texts;
+} progress_t;
+
+static gboolean
+report_progress (gpointer data)
+{
+  progress_t *progress = data;
+  progress->job->progress_func (progress->n_done, progress->n_texts, progress->job->progress_data);
+  return G_SOURCE_REMOVE;
+}
+
+/* Reports the progress on the caller's main context. The job outlives the
+ * report since the task only completes on that same context afterwards. */
+static void
+post_progress (remap_job_t *job, int n_done, int n_texts)
+{
+  if (!job->progress_func)
+    return;
+
+  progress_t *progress = g_new (progress_t, 1);
+  progress->job = job;
+  progress->n_done = n_done;
+  progress->n_texts = n_texts;
+  g_main_context_invoke_full (
+    job->context, G_PRIORITY_DEFAULT, report_progress, progress, g_free);
+}
+
+static LrSplitter *
+split (LrLanguage *language, LrSegmenter *segmenter, int text_id, const gchar *contents)
+{
+  LrText *text = lr_text_new (text_id, language, "", "");
+  lr_text_set_text (text, contents);
+
+  /* Without a database, so that the cached tokenizations are left alone */
+  LrSplitter *splitter =
+    segmenter ? lr_splitter_new_with_segmenter (text, segmenter) : lr_splitter_new (text);
+  g_object_unref (text);
+
+  return splitter;
+}
+
+/* The byte ranges of all words of the splitter */
+static GArray *
+get_word_ranges (LrSplitter *splitter)
+{
+  int n_words = lr_splitter_get_n_words (splitter);
+  GArray *ranges = g_array_sized_new (FALSE, FALSE, sizeof (lr_range_t), n_words);
+  g_array_set_size (ranges, n_words);
+
+  for (int i = 0; i < n_words; i++)
+    lr_splitter_get_word (splitter, i, &g_array_index (ranges, lr_range_t, i));
+
+  return ranges;
+}
+
+gboolean
+lr_remap_words_by_range (GArray *old_ranges, LrSplitter *new_splitter, GArray *old, GArray *new)
+{
+  gboolean all_kept = TRUE;
+  int n_new_words = lr_splitter_get_n_words (new_splitter);
+  g_array_set_size (new, 0);
+
+  if (n_new_words == 0)
+    return old->len == 0;
+
+  for (guint i = 0; i < old->len; i++)
+    {
+      int index = g_array_index (old, int, i);
+      if (index < 0 || (guint)index >= old_ranges->len)
+        continue;
+
+      lr_range_t range = g_array_index (old_ranges, lr_range_t, index);
+
+      int first;
+      int n_words = lr_splitter_get_words_in_range (new_splitter, &range, &first);
+
+      /* A word that is no longer one moves to the closest word after it */
+      if (n_words == 0)
+        {
+          n_words = 1;
+          first = MIN (first, n_new_words - 1);
+          all_kept = FALSE;
+        }
+
+      /* The old words are sorted, so duplicates can only follow each other */
+      for (int word = first; word < first + n_words; word++)
+        {
+          if (new->len == 0 || g_array_index (new, int, new->len - 1) < word)
+            g_array_append_val (new, word);
+        }
+    }
+
+  return all_kept;
+}
+
+static gboolean
+same_words (GArray *first, GArray *second)
+{
+  return first->len == second->len &&
+         memcmp (first->data, second->data, first->len * sizeof (int)) == 0;
+}
+
+/* Computes the new words of the instances of one text, without writing them */
+static void
+remap_text (remap_job_t *job, sqlite3 *db, sqlite3_stmt *select, int text_id)
+{
+  sqlite3_stmt *text_stmt;
+  g_assert (sqlite3_prepare_v2 (db, "SELECT Text FROM Texts WHERE ID = ?1;", -1, &text_stmt, NULL) ==
+            SQLITE_OK);
+  sqlite3_bind_int (text_stmt, 1, text_id);
+
+  if (sqlite3_step (text_stmt) != SQLITE_ROW || sqlite3_column_text (text_stmt, 0) == NULL)
+    {
+      /* Deleted in the meantime, which the final check notices */
+      sqlite3_finalize (text_stmt);
+      return;
+    }
+
+  /* Without the old segmenter the old words are unknown, so the instances
+   * keep their words and are flagged for review */
+  gboolean old_words_known = !job->resegment || job->old_segmenter;
+
+  const gchar *contents = (const gchar *)sqlite3_column_text (text_stmt, 0);
+  GArray *old_ranges = NULL;
+  LrSplitter *new_splitter = NULL;
+  if (old_words_known)
+    {
+      LrSplitter *old_splitter = split (job->old_language, job->old_segmenter, text_id, contents);
+      new_splitter = split (job->new_language, NULL, text_id, contents);
+
+      old_ranges = get_word_ranges (old_splitter);
+      g_object_unref (old_splitter);
+    }
+  sqlite3_finalize (text_stmt);
+
+  GArray *old = g_array_new (FALSE, FALSE, sizeof (int));
+  GArray *new = g_array_new (FALSE, FALSE, sizeof (int));
+
+  sqlite3_reset (select);
+  sqlite3_bind_int (select, 1, text_id);
+  while (sqlite3_step (select) == SQLITE_ROW)
+    {
+      int instance_id = sqlite3_column_int (select, 0);
+      const guint8 *data = sqlite3_column_blob (select, 1);
+      gsize size = sqlite3_column_bytes (select, 1);
+
+      g_hash_table_insert (
+        job->old_words, GINT_TO_POINTER (instance_id), g_bytes_new (data, size));
+
+      g_array_set_size (old, 0);
+      if (!lr_word_list_decode (data, size, old))
+        {
+          g_warning ("Skipping the corrupt words of instance %d", instance_id);
+          continue;
+        }
+
+      gboolean kept = FALSE;
+      if (old_words_known)
+        {
+          kept = lr_remap_words_by_range (old_ranges, new_splitter, old, new);
+          if (kept && same_words (old, new))
+            continue;
+        }
+      else
+        {
+          g_array_set_size (new, 0);
+          g_array_append_vals (new, old->data, old->len);
+        }
+
+      remapped_instance_t remapped = { instance_id, lr_word_list_encode (new), !kept };
+      g_array_append_val (job->remapped, remapped);
+    }
+
+  g_array_free (old, TRUE);
+  g_array_free (new, TRUE);
+  if (old_ranges)
+    g_array_free (old_ranges, TRUE);
+  g_clear_object (&new_splitter);
+}
+
+/* Whether the instances of the language are still the ones that were read */
+static gboolean
+instances_unchanged (remap_job_t *job, sqlite3 *db)
+{
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_prepare_v2 (db,
+                                "SELECT Instances.ID, Instances.Words FROM Instances "
+                                "JOIN Texts ON Texts.ID = Instances.TextID "
+                                "WHERE Texts.LanguageID = ?1;",
+                                -1,
+                                &stmt,
+                                NULL) == SQLITE_OK);
+  sqlite3_bind_int (stmt, 1, lr_language_get_id (job->language));
+
+  gboolean unchanged = TRUE;
+  guint n_instances = 0;
+  while (unchanged && sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      GBytes *words = g_hash_table_lookup (
+        job->old_words, GINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+      gsize size = 0;
+      const guint8 *data = words ? g_bytes_get_data (words, &size) : NULL;
+
+      unchanged = words && size == (gsize)sqlite3_column_bytes (stmt, 1) &&
+                  (size == 0 || memcmp (data, sqlite3_column_blob (stmt, 1), size) == 0);
+      n_instances++;
+    }
+  sqlite3_finalize (stmt);
+
+  return unchanged && n_instances == g_hash_table_size (job->old_words);
+}
+
+static gboolean
+exec (sqlite3 *db, const gchar *sql, GError **error)
+{
+  if (sqlite3_exec (db, sql, NULL, NULL, NULL) == SQLITE_OK)
+    return TRUE;
+
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", sqlite3_errmsg (db));
+  return FALSE;
+}
+
+/* Writes the new words of the instances along with the new regex or
+ * segmenter, in one transaction, so that they are never out of step */
+static gboolean
+save_remapped (remap_job_t *job, sqlite3 *db, GError **error)
+{
+  if (!exec (db, "BEGIN IMMEDIATE;", error))
+    return FALSE;
+
+  /* The instances changed while the texts were split, by an edit of
+   * their text or elsewhere, so their new words could be wrong */
+  if (!instances_unchanged (job, db))
+    {
+      exec (db, "ROLLBACK;", NULL);
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_BUSY,
+                   "The instances of the language changed while they were updated");
+      return FALSE;
+    }
+
+  sqlite3_stmt *update;
+  g_assert (sqlite3_prepare_v2 (
+              db,
+              "UPDATE Instances SET Words = ?2, Stale = Stale OR ?3 WHERE ID = ?1;",
+              -1,
+              &update,
+              NULL) == SQLITE_OK);
+  for (guint i = 0; i < job->remapped->len; i++)
+    {
+      const remapped_instance_t *instance = &g_array_index (job->remapped, remapped_instance_t, i);
+      gsize size;
+      gconstpointer data = g_bytes_get_data (instance->words, &size);
+
+      sqlite3_reset (update);
+      sqlite3_bind_int (update, 1, instance->instance_id);
+      if (size > 0)
+        sqlite3_bind_blob (update, 2, data, size, SQLITE_STATIC);
+      else
+        sqlite3_bind_zeroblob (update, 2, 0);
+      sqlite3_bind_int (update, 3, instance->stale);
+      g_assert (sqlite3_step (update) == SQLITE_DONE);
+    }
+  sqlite3_finalize (update);
+
+  sqlite3_stmt *language_stmt;
+  if (job->resegment)
+    {
+      g_assert (sqlite3_prepare_v2 (
+                  db,
+                  "UPDATE Languages SET SegmenterVersion = ?2, SegmenterWords = ?3 WHERE ID = ?1;",
+                  -1,
+                  &language_stmt,
+                  NULL) == SQLITE_OK);
+      if (job->new_word_list)
+        {
+          gsize size;
+          gconstpointer data = g_bytes_get_data (job->new_word_list, &size);
+          sqlite3_bind_int64 (
+            language_stmt, 2, lr_dict_segmenter_hash_word_list (job->new_word_list));
+          sqlite3_bind_blob (language_stmt, 3, data, size, SQLITE_STATIC);
+        }
+      else
+        {
+          sqlite3_bind_int64 (language_stmt, 2, 0);
+          sqlite3_bind_null (language_stmt, 3);
+        }
+    }
+  else
+    {
+      g_assert (sqlite3_prepare_v2 (db,
+                                    "UPDATE Languages SET WordRegex = ?2 WHERE ID = ?1;",
+                                    -1,
+                                    &language_stmt,
+                                    NULL) == SQLITE_OK);
+      sqlite3_bind_text (language_stmt, 2, job->new_word_regex, -1, SQLITE_STATIC);
+    }
+  sqlite3_bind_int (language_stmt, 1, lr_language_get_id (job->language));
+  g_assert (sqlite3_step (language_stmt) == SQLITE_DONE);
+  sqlite3_finalize (language_stmt);
+
+  if (!exec (db, "COMMIT;", error))
+    {
+      exec (db, "ROLLBACK;", NULL);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static sqlite3 *
+open_connection (const gchar *path, GError **error)
+{
+  sqlite3 *db;
+  if (sqlite3_open_v2 (path, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to open the database: %s",
+                   sqlite3_errmsg (db));
+      sqlite3_close (db);
+      return NULL;
+    }
+  sqlite3_busy_timeout (db, LR_DATABASE_BUSY_TIMEOUT);
+
+  return db;
+}
+
+/* Computes the new words of the instances of all texts of the language,
+ * and then saves them unless the job was cancelled */
+static gboolean
+remap_texts (remap_job_t *job, sqlite3 *db, GCancellable *cancellable, GError **error)
+{
+  /* Only the texts with instances have anything to remap */
+  GArray *text_ids = g_array_new (FALSE, FALSE, sizeof (int));
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_prepare_v2 (db,
+                                "SELECT DISTINCT Texts.ID FROM Texts "
+                                "JOIN Instances ON Instances.TextID = Texts.ID "
+                                "WHERE Texts.LanguageID = ?1;",
+                                -1,
+                                &stmt,
+                                NULL) == SQLITE_OK);
+  sqlite3_bind_int (stmt, 1, lr_language_get_id (job->language));
+  while (sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      int id = sqlite3_column_int (stmt, 0);
+      g_array_append_val (text_ids, id);
+    }
+  sqlite3_finalize (stmt);
+
+  sqlite3_stmt *select;
+  g_assert (sqlite3_prepare_v2 (db,
+                                "SELECT ID, Words FROM Instances WHERE TextID = ?1;",
+                                -1,
+                                &select,
+                                NULL) == SQLITE_OK);
+
+  /* Nothing is written until all texts are split, so a cancelled (or
+   * crashed) job leaves the language with its old words */
+  int n_texts = text_ids->len;
+  post_progress (job, 0, n_texts);
+
+  for (int done = 0; done < n_texts && !g_cancellable_is_cancelled (cancellable); done++)
+    {
+      remap_text (job, db, select, g_array_index (text_ids, int, done));
+      post_progress (job, done + 1, n_texts);
+    }
+  sqlite3_finalize (select);
+  g_array_free (text_ids, TRUE);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  return save_remapped (job, db, error);
+}
+
+static void
+remap_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+  remap_job_t *job = task_data;
+  GError *error = NULL;
+
+  sqlite3 *db = open_connection (job->path, &error);
+  if (db)
+    {
+      remap_texts (job, db, cancellable, &error);
+      sqlite3_close (db);
+    }
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, job->remapped->len);
+}
+
+void
+lr_remap_language_async (LrDatabase *db,
+                         LrLanguage *language,
+                         const gchar *new_word_regex,
+                         GCancellable *cancellable,
+                         lr_remap_progress_func_t progress_func,
+                         gpointer progress_data,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+  g_assert (LR_IS_DATABASE (db));
+  g_assert (LR_IS_LANGUAGE (language));
+
+  remap_job_t *job = remap_job_new (lr_database_get_path (db), language);
+  job->new_word_regex = g_strdup (new_word_regex);
+  job->context = g_main_context_ref_thread_default ();
+  job->progress_func = progress_func;
+  job->progress_data = progress_data;
+
+  /* Copies, so that the job isn't affected by later edits */
+  job->old_language = lr_language_new (lr_language_get_id (language),
+                                       lr_language_get_code (language),
+                                       lr_language_get_name (language),
+                                       lr_language_get_word_regex (language),
+                                       lr_language_get_separator_regex (language));
+  job->new_language = lr_language_new (lr_language_get_id (language),
+                                       lr_language_get_code (language),
+                                       lr_language_get_name (language),
+                                       new_word_regex,
+                                       lr_language_get_separator_regex (language));
+
+  GTask *task = g_task_new (db, cancellable, callback, user_data);
+  g_task_set_task_data (task, job, (GDestroyNotify)remap_job_free);
+
+  /* Once the new regex is committed, the result is reported even if the
+   * job was cancelled meanwhile, so that the language is switched to it */
+  g_task_set_check_cancellable (task, FALSE);
+
+  g_task_run_in_thread (task, remap_thread);
+  g_object_unref (task);
+}
+
+int
+lr_remap_language_finish (LrDatabase *db, GAsyncResult *result, GError **error)
+{
+  g_assert (g_task_is_valid (result, db));
+
+  int n_changed = g_task_propagate_int (G_TASK (result), error);
+  if (n_changed < 0)
+    return -1;
+
+  /* The new regex is saved, the splitters of the old one are of no use */
+  remap_job_t *job = g_task_get_task_data (G_TASK (result));
+  lr_language_set_word_regex (job->language, job->new_word_regex);
+  lr_regex_cache_invalidate_language (lr_language_get_id (job->language));
+  lr_splitter_cache_invalidate_language (lr_language_get_id (job->language));
+
+  return n_changed;
+}
+
+/* The segmenter the instances were saved with: the base one, which keeps
+ * the runs of word characters whole, for version 0, and otherwise the one
+ * of the saved word list if it is still that version */
+static LrSegmenter *
+saved_segmenter_new (guint64 version, gconstpointer words, gsize size)
+{
+  if (version == 0)
+    return g_object_new (LR_TYPE_SEGMENTER, NULL);
+
+  if (!words)
+    return NULL;
+
+  GBytes *word_list = g_bytes_new (words, size);
+  LrSegmenter *segmenter = NULL;
+  if (lr_dict_segmenter_hash_word_list (word_list) == version)
+    segmenter = lr_dict_segmenter_new_from_word_list (word_list);
+  g_bytes_unref (word_list);
+
+  return segmenter;
+}
+
+/* Creates a job for each language whose segmenter isn't the one its
+ * instances were saved with */
+static GPtrArray *
+find_resegmented_languages (const gchar *path, sqlite3 *db)
+{
+  GPtrArray *jobs = g_ptr_array_new_with_free_func ((GDestroyNotify)remap_job_free);
+
+  sqlite3_stmt *stmt;
+  g_assert (sqlite3_prepare_v2 (db,
+                                "SELECT ID, Code, Name, WordRegex, SeparatorRegex, "
+                                "SegmenterVersion, SegmenterWords FROM Languages;",
+                                -1,
+                                &stmt,
+                                NULL) == SQLITE_OK);
+  while (sqlite3_step (stmt) == SQLITE_ROW)
+    {
+      const gchar *code = (const gchar *)sqlite3_column_text (stmt, 1);
+      guint64 saved_version = sqlite3_column_int64 (stmt, 5);
+      if (saved_version == lr_segmenter_get_version_for_language (code))
+        continue;
+
+      LrLanguage *language = lr_language_new (sqlite3_column_int (stmt, 0),
+                                              code,
+                                              (const gchar *)sqlite3_column_text (stmt, 2),
+                                              (const gchar *)sqlite3_column_text (stmt, 3),
+                                              (const gchar *)sqlite3_column_text (stmt, 4));
+
+      remap_job_t *job = remap_job_new (path, language);
+      job->resegment = TRUE;
+      job->old_language = g_object_ref (language);
+      job->new_language = g_object_ref (language);
+      job->old_segmenter = saved_segmenter_new (
+        saved_version, sqlite3_column_blob (stmt, 6), sqlite3_column_bytes (stmt, 6));
+      job->new_word_list = lr_dict_segmenter_find_word_list (code);
+      g_ptr_array_add (jobs, job);
+
+      if (!job->old_segmenter)
+        g_warning ("The word list the instances of %s were saved with is gone, flagging them",
+                   code);
+
+      g_object_unref (language);
+    }
+  sqlite3_finalize (stmt);
+
+  return jobs;
+}
+
+static void
+resegment_thread (GTask *task,
+                  gpointer source_object,
+                  gpointer task_data,
+                  GCancellable *cancellable)
+{
+  const gchar *path = task_data;
+  GError *error = NULL;
+
+  sqlite3 *db = open_connection (path, &error);
+  if (!db)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  GArray *language_ids = g_array_new (FALSE, FALSE, sizeof (int));
+  GPtrArray *jobs = find_resegmented_languages (path, db);
+  for (guint i = 0; i < jobs->len && !error; i++)
+    {
+      remap_job_t *job = g_ptr_array_index (jobs, i);
+      if (remap_texts (job, db, cancellable, &error))
+        {
+          int id = lr_language_get_id (job->language);
+          g_array_append_val (language_ids, id);
+        }
+    }
+  g_ptr_array_unref (jobs);
+  sqlite3_close (db);
+
+  /* The languages done before an error are saved, the rest are retried
+   * the next time */
+  if (error)
+    {
+      g_array_free (language_ids, TRUE);
+      g_task_return_error (task, error);
+    }
+  else
+    {
+      g_task_return_pointer (task, language_ids, (GDestroyNotify)g_array_unref);
+    }
+}
+
+void
+lr_resegment_languages_async (LrDatabase *db,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  g_assert (LR_IS_DATABASE (db));
+
+  GTask *task = g_task_new (db, cancellable, callback, user_data);
+  g_task_set_task_data (task, g_strdup (lr_database_get_path (db)), g_free);
+  g_task_run_in_thread (task, resegment_thread);
+  g_object_unref (task);
+}
+
+int
+lr_resegment_languages_finish (LrDatabase *db, GAsyncResult *result, GError **error)
+{
+  g_assert (g_task_is_valid (result, db));
+
+  GArray *language_ids = g_task_propagate_pointer (G_TASK (result), error);
+  if (!language_ids)
+    return -1;
+
+  /* The splitters of the old segmenters are of no use */
+  for (guint i = 0; i < language_ids->len; i++)
+    lr_splitter_cache_invalidate_language (g_array_index (language_ids, int, i));
+
+  int n_languages = language_ids->len;
+  g_array_unref (language_ids);
+
+  return n_languages;
+}
+
+/* Writes the types of the old words in terms of the types of the new
+ * splitter, with the types missing from it numbered after them */
+static guint32 *
+translate_types (LrSplitter *old_splitter, LrSplitter *new_splitter)
+{
+  GHashTable *new_types = g_hash_table_new (g_str_hash, g_str_equal);
+  int n_new_types = lr_splitter_get_n_types (new_splitter);
+  for (int type = 0; type < n_new_types; type++)
+    g_hash_table_insert (
+      new_types, (gpointer)lr_splitter_get_type_form (new_splitter, type), GINT_TO_POINTER (type));
+
+  int n_old_types = lr_splitter_get_n_types (old_splitter);
+  guint32 *translation = g_new (guint32, n_old_types);
+  for (int type = 0; type < n_old_types; type++)
+    {
+      gpointer new_type;
+      if (g_hash_table_lookup_extended (
+            new_types, lr_splitter_get_type_form (old_splitter, type), NULL, &new_type))
+        translation[type] = GPOINTER_TO_INT (new_type);
+      else
+        translation[type] = n_new_types + type;
+    }
+  g_hash_table_unref (new_types);
+
+  int n_words = lr_splitter_get_n_words (old_splitter);
+  const guint32 *old_types = lr_splitter_get_word_types (old_splitter);
+  guint32 *types = g_new (guint32, n_words);
+  for (int i = 0; i < n_words; i++)
+    types[i] = translation[old_types[i]];
+  g_free (translation);
+
+  return types;
+}
+
+GArray *
+lr_remap_diff_words (LrSplitter *old_splitter, LrSplitter *new_splitter)
+{
+  guint32 *old_types = translate_types (old_splitter, new_splitter);
+  GArray *map = lr_token_diff (old_types,
+                               lr_splitter_get_n_words (old_splitter),
+                               lr_splitter_get_word_types (new_splitter),
+                               lr_splitter_get_n_words (new_splitter));
+  g_free (old_types);
+
+  return map;
+}
+
+gboolean
+lr_remap_instance_words (GArray *map, int n_new_words, GArray *old, GArray *new)
+{
+  gboolean all_kept = TRUE;
+  int fallback = -1;
+  g_array_set_size (new, 0);
+
+  for (guint i = 0; i < old->len; i++)
+    {
+      int index = g_array_index (old, int, i);
+      if (index < 0 || (guint)index >= map->len)
+        continue;
+
+      const lr_token_map_t *entry = &g_array_index (map, lr_token_map_t, index);
+      if (entry->kept)
+        {
+          g_array_append_val (new, entry->index);
+        }
+      else
+        {
+          if (all_kept)
+            fallback = entry->index;
+          all_kept = FALSE;
+        }
+    }
+
+  if (new->len == 0 && fallback >= 0 && n_new_words > 0)
+    {
+      fallback = MIN (fallback, n_new_words - 1);
+      g_array_append_val (new, fallback);
+    }
+
+  return all_kept;
+}
@@ -0,0 +1,112 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_remapper_h
+#define _lr_remapper_h
+
+#include <glib.h>
+#include <gio/gio.h>
+#include "lr-database.h"
+#include "lr-language.h"
+#include "lr-splitter.h"
+
+G_BEGIN_DECLS
+
+/*
+ * The instances store the indices of their words, which depend on the word
+ * regex of the language. When the regex changes, the remapper splits every
+ * text of the language with both regexes and moves each instance to the new
+ * words covering the bytes of its old ones. Instances with words which are
+ * no longer words are flagged stale, like those of edited texts.
+ *
+ * The job splits the texts on a thread with its own database connection,
+ * so the rest of the application keeps working meanwhile. The new words
+ * and the new regex are only saved at the end, in one transaction, so the
+ * saved words always refer to the saved regex.
+ */
+
+/* Called on the main context of the caller after every text */
+typedef void (*lr_remap_progress_func_t) (int n_done, int n_texts, gpointer user_data);
+
+/* Remaps the instances of all texts of the language, which has to be saved
+ * with its current word regex, to new_word_regex, and then saves the new
+ * regex. If the job is cancelled or fails, nothing is saved and the
+ * language keeps its current regex.
+ */
+void lr_remap_language_async (LrDatabase *db,
+                              LrLanguage *language,
+                              const gchar *new_word_regex,
+                              GCancellable *cancellable,
+                              lr_remap_progress_func_t progress_func,
+                              gpointer progress_data,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data);
+
+/* Switches the language to the new regex once it is saved. Returns how
+ * many instances were changed, or -1 on error. */
+int lr_remap_language_finish (LrDatabase *db, GAsyncResult *result, GError **error);
+
+/*
+ * The words of languages written without spaces also depend on the word
+ * list of their segmenter, which can change with an update. The version
+ * and the word list the instances were saved with are stored with the
+ * language, and the instances are moved by byte range from the words of
+ * the saved list to those of the installed one, the same way.
+ */
+
+/* Resegments the instances of every language whose segmenter changed,
+ * saving each language along with the version of its new segmenter. The
+ * instances of a language whose saved word list is missing keep their
+ * words and are flagged stale instead.
+ */
+void lr_resegment_languages_async (LrDatabase *db,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+
+/* Returns how many languages were resegmented, or -1 on error */
+int lr_resegment_languages_finish (LrDatabase *db, GAsyncResult *result, GError **error);
+
+/* Maps the old word indices of an instance to the words of the new
+ * splitter covering the same bytes, given the old words as an array of
+ * lr_range_t. A word which is no longer one moves to the closest word
+ * after it. Returns FALSE if any word did.
+ */
+gboolean
+lr_remap_words_by_range (GArray *old_ranges, LrSplitter *new_splitter, GArray *old, GArray *new);
+
+/*
+ * Editing a text keeps the regex but changes the words. The old and new
+ * words are diffed by their case-folded forms, so an edit only moves the
+ * instances after it.
+ */
+
+/* Returns an array of lr_token_map_t's (see lr-token-diff.h), one for
+ * each word of the old splitter */
+GArray *lr_remap_diff_words (LrSplitter *old_splitter, LrSplitter *new_splitter);
+
+/* Maps the old word indices of an instance through the diff into new.
+ * Deleted words are dropped, unless all of them were, in which case the
+ * instance moves to the word at the place of its first one. Returns FALSE
+ * if any words were deleted.
+ */
+gboolean lr_remap_instance_words (GArray *map, int n_new_words, GArray *old, GArray *new);
+
+G_END_DECLS
+
+#endif /* _lr_remapper_h */
@@ -0,0 +1,140 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-segmenter.h"
+#include "lr-dict-segmenter.h"
+#include "lr-splitter.h"
+
+G_DEFINE_TYPE (LrSegmenter, lr_segmenter, G_TYPE_OBJECT)
+
+static void
+lr_segmenter_init (LrSegmenter *self)
+{
+  /* Instance initialization */
+}
+
+static void
+base_segmenter_segment (
+  LrSegmenter *self, const gchar *text, gsize length, int offset, GArray *words)
+{
+  lr_range_t range = { offset, offset + length };
+  g_array_append_val (words, range);
+}
+
+static guint64
+base_segmenter_get_version (LrSegmenter *self)
+{
+  return 0;
+}
+
+static void
+lr_segmenter_class_init (LrSegmenterClass *klass)
+{
+  klass->segment = base_segmenter_segment;
+  klass->get_version = base_segmenter_get_version;
+}
+
+void
+lr_segmenter_segment (LrSegmenter *self, const gchar *text, gsize length, int offset, GArray *words)
+{
+  g_assert (LR_IS_SEGMENTER (self));
+
+  LR_SEGMENTER_GET_CLASS (self)->segment (self, text, length, offset, words);
+}
+
+guint64
+lr_segmenter_get_version (LrSegmenter *self)
+{
+  g_assert (LR_IS_SEGMENTER (self));
+
+  return LR_SEGMENTER_GET_CLASS (self)->get_version (self);
+}
+
+G_LOCK_DEFINE_STATIC (segmenters);
+
+/* Maps language codes to their segmenters, or to NULL for languages without one */
+static GHashTable *segmenters = NULL;
+
+/* Maps language codes to the versions of their segmenters (guint64 *) */
+static GHashTable *versions = NULL;
+
+static void
+unref_segmenter (gpointer segmenter)
+{
+  if (segmenter)
+    g_object_unref (segmenter);
+}
+
+LrSegmenter *
+lr_segmenter_new_for_language (const gchar *code)
+{
+  G_LOCK (segmenters);
+
+  if (!segmenters)
+    segmenters = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, unref_segmenter);
+
+  LrSegmenter *segmenter;
+  if (!g_hash_table_lookup_extended (segmenters, code, NULL, (gpointer *)&segmenter))
+    {
+      /* Any language with a word list is segmented with it */
+      segmenter = lr_dict_segmenter_new (code);
+      g_hash_table_insert (segmenters, g_strdup (code), segmenter);
+    }
+
+  if (segmenter)
+    g_object_ref (segmenter);
+
+  G_UNLOCK (segmenters);
+
+  return segmenter;
+}
+
+guint64
+lr_segmenter_get_version_for_language (const gchar *code)
+{
+  G_LOCK (segmenters);
+
+  if (!versions)
+    versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  /* Hash the word list rather than build a segmenter which may never be used */
+  guint64 *version = g_hash_table_lookup (versions, code);
+  if (!version)
+    {
+      LrSegmenter *segmenter = NULL;
+      version = g_new (guint64, 1);
+      if (segmenters &&
+          g_hash_table_lookup_extended (segmenters, code, NULL, (gpointer *)&segmenter))
+        {
+          *version = segmenter ? lr_segmenter_get_version (segmenter) : 0;
+        }
+      else
+        {
+          GBytes *word_list = lr_dict_segmenter_find_word_list (code);
+          *version = word_list ? lr_dict_segmenter_hash_word_list (word_list) : 0;
+          g_clear_pointer (&word_list, g_bytes_unref);
+        }
+      g_hash_table_insert (versions, g_strdup (code), version);
+    }
+
+  guint64 result = *version;
+
+  G_UNLOCK (segmenters);
+
+  return result;
+}
@@ -0,0 +1,68 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_segmenter_h
+#define _lr_segmenter_h
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define LR_TYPE_SEGMENTER (lr_segmenter_get_type ())
+G_DECLARE_DERIVABLE_TYPE (LrSegmenter, lr_segmenter, LR, SEGMENTER, GObject)
+
+/*
+ * Segmenters split the runs of word characters the word regex finds into
+ * the actual words, for languages written without spaces between words.
+ */
+struct _LrSegmenterClass
+{
+  GObjectClass parent_class;
+
+  void (*segment) (LrSegmenter *self, const gchar *text, gsize length, int offset, GArray *words);
+
+  /* Identifies the segmentation rules, e.g. the word list, for caching */
+  guint64 (*get_version) (LrSegmenter *self);
+
+  /* No need to add padding since this class is not exposed through an ABI */
+};
+
+/* Appends the words of text, a run of length bytes of word characters,
+ * to words, an array of lr_range_t, with offset added to their ranges.
+ * The base segmenter treats the whole run as a single word.
+ */
+void lr_segmenter_segment (
+  LrSegmenter *self, const gchar *text, gsize length, int offset, GArray *words);
+
+guint64 lr_segmenter_get_version (LrSegmenter *self);
+
+/* Returns a new reference to the segmenter for the language, or NULL if
+ * its words are separated by spaces and need no segmentation. Segmenters
+ * are shared by all texts of a language, so this is cheap after the
+ * first call.
+ */
+LrSegmenter *lr_segmenter_new_for_language (const gchar *code);
+
+/* The version of the segmenter for the language, or 0 if it has none.
+ * The word list is only hashed, the segmenter isn't built. */
+guint64 lr_segmenter_get_version_for_language (const gchar *code);
+
+G_END_DECLS
+
+#endif /* _lr_segmenter_h */
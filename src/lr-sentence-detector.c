@@ -0,0 +1,233 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-sentence-detector.h"
+#include "lr-splitter.h"
+#include <string.h>
+
+lr_sentence_detector_t *
+lr_sentence_detector_new (const gchar *abbreviations)
+{
+  if (abbreviations == NULL)
+    return NULL;
+
+  gchar **list = g_strsplit_set (abbreviations, " \t\n", -1);
+
+  lr_sentence_detector_t *detector = NULL;
+  for (gchar **abbreviation = list; *abbreviation; abbreviation++)
+    {
+      if (**abbreviation == '\0')
+        continue;
+
+      if (detector == NULL)
+        {
+          detector = g_new (lr_sentence_detector_t, 1);
+          detector->abbreviations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          detector->max_length = 0;
+          lr_ascii_set_init_from_chars (&detector->terminals, ".!?");
+        }
+
+      /* Tolerate abbreviations entered without their period */
+      gchar *folded = g_utf8_casefold (*abbreviation, -1);
+      if (!g_str_has_suffix (folded, "."))
+        {
+          gchar *with_period = g_strconcat (folded, ".", NULL);
+          g_free (folded);
+          folded = with_period;
+        }
+
+      detector->max_length = MAX (detector->max_length, strlen (folded));
+      g_hash_table_add (detector->abbreviations, folded);
+    }
+
+  g_strfreev (list);
+  return detector;
+}
+
+void
+lr_sentence_detector_free (lr_sentence_detector_t *detector)
+{
+  if (detector == NULL)
+    return;
+
+  g_hash_table_unref (detector->abbreviations);
+  g_free (detector);
+}
+
+static inline gboolean
+is_space (guchar c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+/* Returns the length of the terminal punctuation at p, or 0. Full width
+ * punctuation ends a sentence even without whitespace after it. */
+static int
+terminal_length (const guchar *p, const guchar *end, gboolean *full_width)
+{
+  if (*p == '.' || *p == '!' || *p == '?')
+    return 1;
+
+  if (*p < 0xE2 || end - p < 3)
+    return 0;
+
+  switch (g_utf8_get_char ((const gchar *)p))
+    {
+    case 0x2026: /* … */
+      return 3;
+    case 0x3002: /* 。 */
+    case 0xFF01: /* ！ */
+    case 0xFF0E: /* ． */
+    case 0xFF1F: /* ？ */
+      *full_width = TRUE;
+      return 3;
+    default:
+      return 0;
+    }
+}
+
+/* Returns the length of the closing quote or bracket at p, or 0 */
+static int
+closing_length (const guchar *p, const guchar *end)
+{
+  if (*p == '"' || *p == '\'' || *p == ')' || *p == ']')
+    return 1;
+
+  if (*p < 0xC2 || end - p < 2)
+    return 0;
+
+  gunichar c = g_utf8_get_char ((const gchar *)p);
+  if (c == 0x00BB || c == 0x2019 || c == 0x201D || c == 0xFF09 || c == 0x300D)
+    return g_utf8_skip[*p];
+
+  return 0;
+}
+
+/* Whether the period at offset period ends one of the abbreviations. The
+ * text after it, up to end, tells single letter abbreviations apart from
+ * words and initials at the end of a sentence. */
+static gboolean
+follows_abbreviation (const lr_sentence_detector_t *detector,
+                      const gchar *text,
+                      gsize period,
+                      const guchar *after,
+                      const guchar *end)
+{
+  /* The token starts after the previous whitespace or opening bracket */
+  gsize start = period;
+  while (start > 0)
+    {
+      guchar c = text[start - 1];
+      if (is_space (c) || c == '(' || c == '[' || c == '"')
+        break;
+
+      /* Too long to be an abbreviation */
+      if (period - start + 1 >= detector->max_length)
+        return FALSE;
+      start--;
+    }
+
+  if (start == period)
+    return FALSE;
+
+  /* Skip any opening quotes which aren't ASCII */
+  while (start < period)
+    {
+      gunichar c = g_utf8_get_char (text + start);
+      if (c != 0x00AB && c != 0x201C && c != 0x201E && c != 0x00BF && c != 0x00A1)
+        break;
+      start = g_utf8_next_char (text + start) - text;
+    }
+
+  gchar *folded = g_utf8_casefold (text + start, period - start + 1);
+  gboolean found = g_hash_table_contains (detector->abbreviations, folded);
+  gboolean single_letter = g_utf8_strlen (folded, -1) == 2;
+  g_free (folded);
+
+  if (!found || !single_letter)
+    return found;
+
+  /* A single letter is just as likely a word or an initial ending the
+   * sentence, as in "w 1999 r. Potem", so the sentence only goes on if
+   * the next word starts in lowercase */
+  while (after < end && is_space (*after))
+    after++;
+
+  return after < end && g_unichar_islower (g_utf8_get_char ((const gchar *)after));
+}
+
+void
+lr_sentence_detector_split (const lr_sentence_detector_t *detector,
+                            const gchar *text,
+                            gsize start,
+                            gsize length,
+                            GArray *ranges)
+{
+  const guchar *data = (const guchar *)text;
+  const guchar *end = data + length;
+  const guchar *p = data + start;
+
+  while (p < end)
+    {
+      gboolean full_width = FALSE;
+      int n = terminal_length (p, end, &full_width);
+      if (n == 0)
+        {
+          /* Skip ahead to the next punctuation or non-ASCII byte */
+          p++;
+          while (detector->terminals.vectorized && end - p >= LR_ASCII_BLOCK_SIZE)
+            {
+              guint32 non_ascii;
+              guint32 stops = lr_ascii_set_classify (&detector->terminals, p, &non_ascii);
+              stops |= non_ascii;
+              if (stops)
+                {
+                  p += lr_lowest_bit (stops);
+                  break;
+                }
+              p += LR_ASCII_BLOCK_SIZE;
+            }
+          continue;
+        }
+
+      /* The whole run of punctuation, as in "?!" or "..." */
+      const guchar *punctuation = p;
+      int n_marks = 0;
+      while (p < end && (n = terminal_length (p, end, &full_width)) > 0)
+        {
+          p += n;
+          n_marks++;
+        }
+
+      while (p < end && (n = closing_length (p, end)) > 0)
+        p += n;
+
+      gboolean ends_sentence = full_width || p == end || is_space (*p);
+      if (ends_sentence && !full_width && n_marks == 1 && *punctuation == '.')
+        ends_sentence = !follows_abbreviation (detector, text, punctuation - data, p, end);
+
+      if (!ends_sentence)
+        continue;
+
+      while (p < end && is_space (*p))
+        p++;
+
+      lr_range_t range = { punctuation - data, p - data };
+      g_array_append_val (ranges, range);
+    }
+}
@@ -0,0 +1,67 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_sentence_detector_h
+#define _lr_sentence_detector_h
+
+#include <glib.h>
+#include "lr-ascii-set.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Finds the ends of sentences without a regex: a run of terminal
+ * punctuation (".", "!", "?", "…" and their full width forms), possibly
+ * followed by closing quotes or brackets, ends a sentence when whitespace
+ * or the end of the text follows it. A lone period does not if the token
+ * before it is one of the language's abbreviations, and for abbreviations
+ * of a single letter the next word also has to start in lowercase.
+ */
+typedef struct
+{
+  /* Case folded abbreviations, including their final period */
+  GHashTable *abbreviations;
+
+  /* The length in bytes of the longest abbreviation */
+  gsize max_length;
+
+  /* The ASCII terminal punctuation, to skip the text between quickly */
+  lr_ascii_set_t terminals;
+} lr_sentence_detector_t;
+
+/* Creates a detector for the space separated abbreviations, as stored with
+ * LrLanguage. Returns NULL if there are none, in which case sentences are
+ * split with the separator regex instead.
+ */
+lr_sentence_detector_t *lr_sentence_detector_new (const gchar *abbreviations);
+void lr_sentence_detector_free (lr_sentence_detector_t *detector);
+
+/* Appends the byte ranges of the separators between start and length in
+ * text to ranges, an array of lr_range_t. Each separator spans the
+ * punctuation and the whitespace after it. The text before start is only
+ * looked at to recognize abbreviations.
+ */
+void lr_sentence_detector_split (const lr_sentence_detector_t *detector,
+                                 const gchar *text,
+                                 gsize start,
+                                 gsize length,
+                                 GArray *ranges);
+
+G_END_DECLS
+
+#endif /* _lr_sentence_detector_h */
@@ -0,0 +1,215 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-splitter-cache.h"
+#include <string.h>
+
+typedef struct
+{
+  int text_id;
+  int language_id;
+  gint64 version;
+
+  LrSplitter *splitter;
+
+  /* The memory of the splitter and of its text */
+  gsize size;
+} cache_entry_t;
+
+G_LOCK_DEFINE_STATIC (cache);
+
+/* Maps text IDs to the links of their entries in the LRU list */
+static GHashTable *entries = NULL;
+
+/* The entries, most recently used first */
+static GQueue lru = G_QUEUE_INIT;
+
+static gsize budget = LR_SPLITTER_CACHE_DEFAULT_BUDGET;
+static gsize total_size = 0;
+
+/* Map text and language IDs to how many times they have been invalidated,
+ * so that a splitter built from contents which changed while it was being
+ * split is not put in the cache.
+ */
+static GHashTable *text_generations = NULL;
+static GHashTable *language_generations = NULL;
+
+static guint
+get_generation (GHashTable *generations, int id)
+{
+  if (!generations)
+    return 0;
+
+  return GPOINTER_TO_UINT (g_hash_table_lookup (generations, GINT_TO_POINTER (id)));
+}
+
+static void
+bump_generation (GHashTable **generations, int id)
+{
+  if (!*generations)
+    *generations = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  guint generation = get_generation (*generations, id) + 1;
+  g_hash_table_insert (*generations, GINT_TO_POINTER (id), GUINT_TO_POINTER (generation));
+}
+
+static void
+remove_link (GList *link)
+{
+  cache_entry_t *entry = link->data;
+
+  g_hash_table_remove (entries, GINT_TO_POINTER (entry->text_id));
+  g_queue_delete_link (&lru, link);
+  total_size -= entry->size;
+
+  /* Users of the splitter keep their own reference */
+  g_object_unref (entry->splitter);
+  g_free (entry);
+}
+
+static void
+evict (void)
+{
+  while (total_size > budget && lru.tail)
+    remove_link (lru.tail);
+}
+
+LrSplitter *
+lr_splitter_cache_lookup (LrText *text, LrDatabase *db)
+{
+  g_assert (LR_IS_TEXT (text));
+
+  int text_id = lr_text_get_id (text);
+  if (text_id < 0)
+    return lr_splitter_new_with_database (text, db);
+
+  LrLanguage *language = lr_text_get_language (text);
+  int language_id = lr_language_get_id (language);
+  gint64 version = lr_splitter_get_tokenization_version (language);
+
+  G_LOCK (cache);
+
+  if (!entries)
+    entries = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  GList *link = g_hash_table_lookup (entries, GINT_TO_POINTER (text_id));
+  if (link)
+    {
+      cache_entry_t *entry = link->data;
+      if (entry->version == version)
+        {
+          /* Move it to the front */
+          g_queue_unlink (&lru, link);
+          g_queue_push_head_link (&lru, link);
+
+          LrSplitter *splitter = g_object_ref (entry->splitter);
+          G_UNLOCK (cache);
+          return splitter;
+        }
+
+      /* Split with regexes which have changed since */
+      remove_link (link);
+    }
+
+  guint text_generation = get_generation (text_generations, text_id);
+  guint language_generation = get_generation (language_generations, language_id);
+
+  G_UNLOCK (cache);
+
+  /* Split without holding the lock, so that other texts can be looked up meanwhile */
+  LrSplitter *splitter = lr_splitter_new_with_database (text, db);
+
+  G_LOCK (cache);
+
+  /* The text or its language changed while it was being split, so the
+   * splitter is only good for the caller.
+   */
+  if (get_generation (text_generations, text_id) != text_generation ||
+      get_generation (language_generations, language_id) != language_generation)
+    {
+      G_UNLOCK (cache);
+      return splitter;
+    }
+
+  cache_entry_t *entry = g_new (cache_entry_t, 1);
+  entry->text_id = text_id;
+  entry->language_id = language_id;
+  entry->version = version;
+  entry->splitter = g_object_ref (splitter);
+  entry->size = lr_splitter_get_memory_size (splitter) + strlen (lr_text_get_text (text)) + 1;
+
+  /* Another thread may have split the same text in the meantime */
+  link = g_hash_table_lookup (entries, GINT_TO_POINTER (text_id));
+  if (link)
+    remove_link (link);
+
+  g_queue_push_head (&lru, entry);
+  g_hash_table_insert (entries, GINT_TO_POINTER (text_id), lru.head);
+  total_size += entry->size;
+
+  evict ();
+
+  G_UNLOCK (cache);
+
+  return splitter;
+}
+
+void
+lr_splitter_cache_set_budget (gsize new_budget)
+{
+  G_LOCK (cache);
+
+  budget = new_budget;
+  if (entries)
+    evict ();
+
+  G_UNLOCK (cache);
+}
+
+void
+lr_splitter_cache_invalidate_text (int text_id)
+{
+  G_LOCK (cache);
+
+  bump_generation (&text_generations, text_id);
+
+  GList *link = entries ? g_hash_table_lookup (entries, GINT_TO_POINTER (text_id)) : NULL;
+  if (link)
+    remove_link (link);
+
+  G_UNLOCK (cache);
+}
+
+void
+lr_splitter_cache_invalidate_language (int language_id)
+{
+  G_LOCK (cache);
+
+  bump_generation (&language_generations, language_id);
+
+  GList *link = lru.head;
+  while (link)
+    {
+      GList *next = link->next;
+      if (((cache_entry_t *)link->data)->language_id == language_id)
+        remove_link (link);
+      link = next;
+    }
+
+  G_UNLOCK (cache);
+}
@@ -0,0 +1,54 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_splitter_cache_h
+#define _lr_splitter_cache_h
+
+#include <glib.h>
+#include "lr-splitter.h"
+
+G_BEGIN_DECLS
+
+/*
+ * A process-wide cache of the splitters of the texts read recently, so
+ * that the reader and the exporter share them and re-opening a text does
+ * not split it again. The least recently used splitters are dropped once
+ * their memory exceeds the budget. It can be used from any thread.
+ */
+
+#define LR_SPLITTER_CACHE_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+/* Returns a new reference to the splitter of the text, creating it (with
+ * the tokenization cached in db, which may be NULL) if it isn't cached for
+ * the current tokenization version of its language. Texts which haven't
+ * been saved yet get a splitter of their own.
+ */
+LrSplitter *lr_splitter_cache_lookup (LrText *text, LrDatabase *db);
+
+/* Sets how many bytes the cached splitters and their texts may take */
+void lr_splitter_cache_set_budget (gsize budget);
+
+/* Drops the splitter of a text, after it has been edited or removed */
+void lr_splitter_cache_invalidate_text (int text_id);
+
+/* Drops the splitters of all texts of a language, after it has been edited or removed */
+void lr_splitter_cache_invalidate_language (int language_id);
+
+G_END_DECLS
+
+#endif /* _lr_splitter_cache_h */
@@ -17,24 +17,65 @@
  */
 
 #include "lr-splitter.h"
+#include "lr-char-class.h"
+#include "lr-preset-classes.h"
+#include "lr-regex-cache.h"
+#include "lr-segmenter.h"
+#include "lr-sentence-detector.h"
+#include "lr-varint.h"
+#include "lr-word-list.h"
+#include <string.h>
+
+/*
+ * Ranges stored as parallel arrays of starts and lengths, both in bytes
+ * and in characters (as GtkTextBuffer counts them), which takes half the
+ * memory of lr_range_t's once the character offsets are included and
+ * keeps the starts packed together for the binary searches.
+ */
+typedef struct
+{
+  guint len;
+  guint32 *starts;
+  guint32 *lengths;
+  guint32 *char_starts;
+  guint32 *char_lengths;
+} range_table_t;
 
 struct _LrSplitter
 {
   GObject parent_instance;
 
   LrText *text;
-
-  GRegex *word_regex;
-  GRegex *separator_regex;
-
-  GArray *words;
-  GArray *separators;
+  LrDatabase *db;
+
+  /* Splits with this segmenter instead of the language's, if set */
+  LrSegmenter *segmenter;
+
+  range_table_t words;
+  range_table_t separators;
+
+  /* Sentence k runs from the end of separator k - 1 (or the start of the
+   * text) to the end of separator k (or the end of the text), and
+   * word_sentences maps each word to the sentence it starts in */
+  guint32 *word_sentences;
+  guint32 text_length;
+
+  /* The type of each word, i.e. the index of its case-folded form. The
+   * forms are stored NUL-terminated one after the other in type_pool,
+   * starting at type_offsets. */
+  guint32 *word_types;
+  guint n_types;
+  guint32 *type_offsets;
+  guint32 *type_counts;
+  GString *type_pool;
 };
 
 enum
 {
   PROP_0,
   PROP_TEXT,
+  PROP_DATABASE,
+  PROP_SEGMENTER,
   N_PROPERTIES
 };
 
@@ -42,6 +83,10 @@ static GParamSpec *obj_properties[N_PROPERTIES] = {
   NULL,
 };
 
+/* Bump this whenever the splitting rules change, to invalidate the
+ * tokenizations cached in the database */
+#define TOKENIZATION_VERSION 1
+
 G_DEFINE_TYPE (LrSplitter, lr_splitter, G_TYPE_OBJECT)
 
 static void
@@ -50,47 +95,521 @@ lr_splitter_init (LrSplitter *self)
 }
 
 static void
-lr_splitter_constructed (GObject *obj)
+append_regex_matches (GRegex *regex, const gchar *text, GArray *ranges)
 {
-  LrSplitter *self = LR_SPLITTER (obj);
-  g_assert (LR_IS_TEXT (self->text));
-
-  LrText *text = self->text;
-  const gchar *word_regex_string = lr_language_get_word_regex (lr_text_get_language (text));
-  const gchar *separator_regex_string =
-    lr_language_get_separator_regex (lr_text_get_language (text));
-
-  self->word_regex = g_regex_new (word_regex_string, 0, 0, NULL);
-  g_assert (self->word_regex != NULL);
-
-  self->separator_regex = g_regex_new (separator_regex_string, 0, 0, NULL);
-  g_assert (self->separator_regex != NULL);
-
-  self->words = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
-  self->separators = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+  /* A regex which doesn't compile matches nothing */
+  if (!regex)
+    return;
 
-  /* Split the text */
   GMatchInfo *match_info;
-  g_regex_match (self->word_regex, lr_text_get_text (text), 0, &match_info);
+  g_regex_match (regex, text, 0, &match_info);
   while (g_match_info_matches (match_info))
     {
       lr_range_t range;
       g_match_info_fetch_pos (match_info, 0, &range.start, &range.end);
-      g_array_append_val (self->words, range);
+      g_array_append_val (ranges, range);
       g_match_info_next (match_info, NULL);
     }
+  g_match_info_free (match_info);
+}
 
-  /* Find the separators as well */
-  g_regex_match (self->separator_regex, lr_text_get_text (text), 0, &match_info);
-  while (g_match_info_matches (match_info))
+/* Texts shorter than this are split on the calling thread */
+#define PARALLEL_THRESHOLD (256 * 1024)
+
+/* A part of the text split on a worker thread */
+typedef struct
+{
+  const gchar *text;
+  int start;
+  int end;
+
+  /* Exactly one of these is set */
+  const lr_char_class_t *word_class;
+  const lr_sentence_detector_t *detector;
+  GRegex *regex;
+
+  /* Ranges relative to the start of the whole text */
+  GArray *ranges;
+} split_job_t;
+
+static void
+run_split_job (gpointer data, gpointer user_data)
+{
+  split_job_t *job = data;
+
+  if (job->word_class)
+    {
+      lr_char_class_split (job->word_class, job->text + job->start, job->end - job->start,
+                           job->ranges);
+      for (guint i = 0; i < job->ranges->len; i++)
+        {
+          lr_range_t *range = &g_array_index (job->ranges, lr_range_t, i);
+          range->start += job->start;
+          range->end += job->start;
+        }
+    }
+  else if (job->detector)
+    {
+      lr_sentence_detector_split (job->detector, job->text, job->start, job->end, job->ranges);
+    }
+  else
+    {
+      append_regex_matches (job->regex, job->text, job->ranges);
+    }
+}
+
+/* Returns the first offset at or after offset which is not inside a word,
+ * so that no word is split between two jobs */
+static int
+find_chunk_boundary (const lr_char_class_t *word_class, const gchar *text, int offset, int length)
+{
+  /* Move to the start of a character first */
+  while (offset < length && (text[offset] & 0xC0) == 0x80)
+    offset++;
+
+  while (offset < length)
+    {
+      const gchar *p = text + offset;
+      if (!lr_char_class_contains (word_class, g_utf8_get_char (p)))
+        return offset;
+      offset = g_utf8_next_char (p) - text;
+    }
+
+  return length;
+}
+
+/*
+ * Splits large texts on all cores. The separators are matched on a thread
+ * of their own, while the words are split in one chunk per core when they
+ * are a character class; chunks end outside of words, so the result is
+ * exactly the same as splitting the whole text at once.
+ */
+static void
+split_text_in_parallel (GArray *words,
+                        GArray *separators,
+                        const gchar *text,
+                        int length,
+                        const lr_char_class_t *word_class,
+                        GRegex *word_regex,
+                        lr_sentence_detector_t *detector,
+                        GRegex *separator_regex)
+{
+  guint n_word_jobs = 1;
+  if (word_class)
+    n_word_jobs = MAX (1, g_get_num_processors () - 1);
+
+  split_job_t *jobs = g_new0 (split_job_t, n_word_jobs + 1);
+  GThreadPool *pool =
+    g_thread_pool_new (run_split_job, NULL, n_word_jobs + 1, FALSE, NULL);
+
+  /* The separators */
+  jobs[0].text = text;
+  jobs[0].end = length;
+  jobs[0].detector = detector;
+  jobs[0].regex = separator_regex;
+  jobs[0].ranges = separators;
+  g_thread_pool_push (pool, &jobs[0], NULL);
+
+  /* The words */
+  int start = 0;
+  for (guint i = 1; i <= n_word_jobs; i++)
+    {
+      split_job_t *job = &jobs[i];
+      job->text = text;
+      job->start = start;
+      job->end = find_chunk_boundary (word_class, text, (gint64)length * i / n_word_jobs, length);
+      job->word_class = word_class;
+      job->regex = word_regex;
+      job->ranges = (i == 1) ? words : g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+      start = job->end;
+
+      g_thread_pool_push (pool, job, NULL);
+    }
+
+  /* Wait for all jobs to finish */
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  /* Merge the words, which are already in order */
+  for (guint i = 2; i <= n_word_jobs; i++)
+    {
+      g_array_append_vals (words, jobs[i].ranges->data, jobs[i].ranges->len);
+      g_array_free (jobs[i].ranges, TRUE);
+    }
+
+  g_free (jobs);
+}
+
+/* Splits the runs of word characters into the words of the segmenter */
+static void
+segment_words (LrSegmenter *segmenter, const gchar *text, GArray *words)
+{
+  GArray *runs = g_array_sized_new (FALSE, FALSE, sizeof (lr_range_t), words->len);
+  g_array_append_vals (runs, words->data, words->len);
+  g_array_set_size (words, 0);
+
+  for (guint i = 0; i < runs->len; i++)
+    {
+      const lr_range_t *run = &g_array_index (runs, lr_range_t, i);
+      lr_segmenter_segment (segmenter, text + run->start, run->end - run->start, run->start, words);
+    }
+
+  g_array_free (runs, TRUE);
+}
+
+static void
+split_text (LrSplitter *self, LrSegmenter *segmenter, GArray *words, GArray *separators)
+{
+  LrLanguage *language = lr_text_get_language (self->text);
+  const gchar *text = lr_text_get_text (self->text);
+  gsize length = strlen (text);
+
+  /* Split the text, without GRegex if the word regex is a simple character class.
+   * The classes of the presets are compiled in already. */
+  const gchar *word_regex_string = lr_language_get_word_regex (language);
+  lr_char_class_t *parsed_class = NULL;
+  const lr_char_class_t *word_class = lr_preset_class_lookup (word_regex_string);
+  if (!word_class)
+    word_class = parsed_class = lr_char_class_new_from_regex (word_regex_string);
+
+  GRegex *word_regex = NULL;
+  if (!word_class)
+    {
+      word_regex = lr_regex_cache_lookup (lr_language_get_id (language), word_regex_string);
+    }
+
+  /* The abbreviations, when there are any, replace the separator regex */
+  lr_sentence_detector_t *detector =
+    lr_sentence_detector_new (lr_language_get_abbreviations (language));
+  GRegex *separator_regex = NULL;
+  if (!detector)
+    {
+      separator_regex = lr_regex_cache_lookup (lr_language_get_id (language),
+                                               lr_language_get_separator_regex (language));
+    }
+
+  if (length >= PARALLEL_THRESHOLD && g_get_num_processors () > 1)
     {
+      split_text_in_parallel (
+        words, separators, text, length, word_class, word_regex, detector, separator_regex);
+    }
+  else
+    {
+      if (word_class)
+        lr_char_class_split (word_class, text, length, words);
+      else
+        append_regex_matches (word_regex, text, words);
+
+      if (detector)
+        lr_sentence_detector_split (detector, text, 0, length, separators);
+      else
+        append_regex_matches (separator_regex, text, separators);
+    }
+
+  if (segmenter)
+    segment_words (segmenter, text, words);
+
+  lr_char_class_free (parsed_class);
+  g_clear_pointer (&word_regex, g_regex_unref);
+  lr_sentence_detector_free (detector);
+  g_clear_pointer (&separator_regex, g_regex_unref);
+}
+
+/* FNV-1a hash of the language's regexes, abbreviations and segmenter version
+ * (0 for none), which identifies a tokenization */
+static gint64
+tokenization_hash (LrLanguage *language, guint64 segmenter_version)
+{
+  const gchar *abbreviations = lr_language_get_abbreviations (language);
+  const gchar *strings[] = { lr_language_get_word_regex (language),
+                             lr_language_get_separator_regex (language),
+                             abbreviations ? abbreviations : "" };
+
+  guint64 hash = 0xcbf29ce484222325ull ^ TOKENIZATION_VERSION;
+  for (guint i = 0; i < G_N_ELEMENTS (strings); i++)
+    {
+      /* Include the terminating NUL to separate the strings */
+      const guchar *p = (const guchar *)strings[i];
+      do
+        {
+          hash ^= *p;
+          hash *= 0x100000001b3ull;
+        }
+      while (*p++);
+    }
+
+  if (segmenter_version)
+    {
+      hash ^= segmenter_version;
+      hash *= 0x100000001b3ull;
+    }
+
+  return (gint64)hash;
+}
+
+gint64
+lr_splitter_get_tokenization_version (LrLanguage *language)
+{
+  g_assert (LR_IS_LANGUAGE (language));
+
+  return tokenization_hash (
+    language, lr_segmenter_get_version_for_language (lr_language_get_code (language)));
+}
+
+/*
+ * Cached ranges are stored as pairs of varints: the gap since the end of
+ * the previous range and the length of the range.
+ */
+static GBytes *
+serialize_ranges (const range_table_t *ranges)
+{
+  GByteArray *bytes = g_byte_array_sized_new (ranges->len * 2);
+
+  guint32 previous_end = 0;
+  for (guint i = 0; i < ranges->len; i++)
+    {
+      lr_varint_append (bytes, ranges->starts[i] - previous_end);
+      lr_varint_append (bytes, ranges->lengths[i]);
+      previous_end = ranges->starts[i] + ranges->lengths[i];
+    }
+
+  return g_byte_array_free_to_bytes (bytes);
+}
+
+static gboolean
+deserialize_ranges (GBytes *bytes, gsize text_length, GArray *ranges)
+{
+  gsize size;
+  const guint8 *p = g_bytes_get_data (bytes, &size);
+  const guint8 *end = p + size;
+
+  gsize previous_end = 0;
+  while (p < end)
+    {
+      guint32 gap, length;
+      if (!lr_varint_read (&p, end, &gap) || !lr_varint_read (&p, end, &length))
+        return FALSE;
+
       lr_range_t range;
-      g_match_info_fetch_pos (match_info, 0, &range.start, &range.end);
-      g_array_append_val (self->separators, range);
-      g_match_info_next (match_info, NULL);
+      range.start = previous_end + gap;
+      range.end = range.start + length;
+      if ((gsize)range.end > text_length || range.end < range.start)
+        return FALSE;
+
+      g_array_append_val (ranges, range);
+      previous_end = range.end;
     }
 
-  g_match_info_free (match_info);
+  return TRUE;
+}
+
+static gboolean
+load_tokenization (LrSplitter *self, gint64 hash, GArray *word_ranges, GArray *separator_ranges)
+{
+  GBytes *words, *separators;
+  if (!lr_database_load_tokenization (self->db, self->text, hash, &words, &separators))
+    return FALSE;
+
+  gsize text_length = strlen (lr_text_get_text (self->text));
+  gboolean valid = deserialize_ranges (words, text_length, word_ranges) &&
+                   deserialize_ranges (separators, text_length, separator_ranges);
+
+  g_bytes_unref (words);
+  g_bytes_unref (separators);
+
+  if (!valid)
+    {
+      g_warning ("Ignoring corrupt tokenization of text %d", lr_text_get_id (self->text));
+      g_array_set_size (word_ranges, 0);
+      g_array_set_size (separator_ranges, 0);
+    }
+
+  return valid;
+}
+
+static void
+store_tokenization (LrSplitter *self, gint64 hash)
+{
+  GBytes *words = serialize_ranges (&self->words);
+  GBytes *separators = serialize_ranges (&self->separators);
+
+  lr_database_store_tokenization (self->db, self->text, hash, words, separators);
+
+  g_bytes_unref (words);
+  g_bytes_unref (separators);
+}
+
+/* Packs the sorted ranges into a table, counting their characters in one
+ * pass over the text */
+static void
+range_table_init (range_table_t *table, const gchar *text, GArray *ranges)
+{
+  table->len = ranges->len;
+  table->starts = g_new (guint32, ranges->len);
+  table->lengths = g_new (guint32, ranges->len);
+  table->char_starts = g_new (guint32, ranges->len);
+  table->char_lengths = g_new (guint32, ranges->len);
+
+  int byte_offset = 0;
+  guint32 char_offset = 0;
+  for (guint i = 0; i < ranges->len; i++)
+    {
+      const lr_range_t *range = &g_array_index (ranges, lr_range_t, i);
+      table->starts[i] = range->start;
+      table->lengths[i] = range->end - range->start;
+
+      char_offset += g_utf8_pointer_to_offset (text + byte_offset, text + range->start);
+      table->char_starts[i] = char_offset;
+      table->char_lengths[i] = g_utf8_pointer_to_offset (text + range->start, text + range->end);
+      char_offset += table->char_lengths[i];
+
+      byte_offset = range->end;
+    }
+}
+
+static void
+range_table_clear (range_table_t *table)
+{
+  g_clear_pointer (&table->starts, g_free);
+  g_clear_pointer (&table->lengths, g_free);
+  g_clear_pointer (&table->char_starts, g_free);
+  g_clear_pointer (&table->char_lengths, g_free);
+  table->len = 0;
+}
+
+static inline guint32
+range_table_end (const range_table_t *table, guint i)
+{
+  return table->starts[i] + table->lengths[i];
+}
+
+static inline void
+range_table_get (const range_table_t *table, guint i, lr_range_t *range)
+{
+  range->start = table->starts[i];
+  range->end = table->starts[i] + table->lengths[i];
+}
+
+/* A word is in the sentence after the last separator ending at or before its start */
+static void
+map_words_to_sentences (LrSplitter *self)
+{
+  self->word_sentences = g_new (guint32, self->words.len);
+
+  guint sentence = 0;
+  for (guint i = 0; i < self->words.len; i++)
+    {
+      while (sentence < self->separators.len &&
+             range_table_end (&self->separators, sentence) <= self->words.starts[i])
+        sentence++;
+
+      self->word_sentences[i] = sentence;
+    }
+}
+
+/* Interns the case-folded form of each word, in a single pass over the words */
+static void
+intern_word_types (LrSplitter *self, const gchar *text)
+{
+  self->word_types = g_new (guint32, self->words.len);
+  self->type_pool = g_string_new (NULL);
+
+  GArray *offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+  GArray *counts = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  /* Maps the forms, owned by the table, to their type plus one */
+  GHashTable *types = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  GString *folded = g_string_new (NULL);
+  for (guint i = 0; i < self->words.len; i++)
+    {
+      const gchar *word = text + self->words.starts[i];
+      guint32 length = self->words.lengths[i];
+
+      /* Case-fold ASCII words in place, without allocating */
+      gboolean ascii = TRUE;
+      g_string_truncate (folded, 0);
+      for (guint32 j = 0; j < length && ascii; j++)
+        {
+          ascii = !(word[j] & 0x80);
+          g_string_append_c (folded, g_ascii_tolower (word[j]));
+        }
+
+      if (!ascii)
+        {
+          gchar *casefold = g_utf8_casefold (word, length);
+          g_string_assign (folded, casefold);
+          g_free (casefold);
+        }
+
+      guint32 type = GPOINTER_TO_UINT (g_hash_table_lookup (types, folded->str));
+      if (type == 0)
+        {
+          type = offsets->len + 1;
+          g_hash_table_insert (types, g_strdup (folded->str), GUINT_TO_POINTER (type));
+
+          guint32 offset = self->type_pool->len;
+          guint32 zero = 0;
+          g_array_append_val (offsets, offset);
+          g_array_append_val (counts, zero);
+          g_string_append_len (self->type_pool, folded->str, folded->len + 1);
+        }
+
+      self->word_types[i] = type - 1;
+      g_array_index (counts, guint32, type - 1)++;
+    }
+
+  self->n_types = offsets->len;
+  self->type_offsets = (guint32 *)g_array_free (offsets, FALSE);
+  self->type_counts = (guint32 *)g_array_free (counts, FALSE);
+
+  g_string_free (folded, TRUE);
+  g_hash_table_unref (types);
+}
+
+static void
+lr_splitter_constructed (GObject *obj)
+{
+  LrSplitter *self = LR_SPLITTER (obj);
+  g_assert (LR_IS_TEXT (self->text));
+
+  /* Collect the ranges first, then pack them into the tables */
+  GArray *words = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+  GArray *separators = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+
+  /* Languages written without spaces have their words segmented further */
+  LrLanguage *language = lr_text_get_language (self->text);
+  LrSegmenter *segmenter = self->segmenter
+                             ? g_object_ref (self->segmenter)
+                             : lr_segmenter_new_for_language (lr_language_get_code (language));
+
+  /* Texts which haven't been saved yet can't be cached, and neither can
+   * those split with another segmenter than their language's */
+  gboolean cache = self->db && !self->segmenter && lr_text_get_id (self->text) >= 0;
+  gint64 hash = 0;
+  gboolean loaded = FALSE;
+  if (cache)
+    {
+      hash = tokenization_hash (language, segmenter ? lr_segmenter_get_version (segmenter) : 0);
+      loaded = load_tokenization (self, hash, words, separators);
+    }
+
+  if (!loaded)
+    split_text (self, segmenter, words, separators);
+
+  g_clear_object (&segmenter);
+
+  const gchar *text = lr_text_get_text (self->text);
+  range_table_init (&self->words, text, words);
+  range_table_init (&self->separators, text, separators);
+  g_array_free (words, TRUE);
+  g_array_free (separators, TRUE);
+
+  self->text_length = strlen (text);
+  map_words_to_sentences (self);
+  intern_word_types (self, text);
+
+  if (cache && !loaded)
+    store_tokenization (self, hash);
 }
 
 static void
@@ -98,9 +617,15 @@ lr_splitter_finalize (GObject *object)
 {
   LrSplitter *self = LR_SPLITTER (object);
 
-  g_array_free (self->words, TRUE);
-  g_regex_unref (self->word_regex);
-  g_regex_unref (self->separator_regex);
+  range_table_clear (&self->words);
+  range_table_clear (&self->separators);
+  g_free (self->word_sentences);
+  g_free (self->word_types);
+  g_free (self->type_offsets);
+  g_free (self->type_counts);
+  g_string_free (self->type_pool, TRUE);
+  g_clear_object (&self->text);
+  g_clear_object (&self->segmenter);
 
   G_OBJECT_CLASS (lr_splitter_parent_class)->finalize (object);
 }
@@ -116,7 +641,15 @@ lr_splitter_set_property (GObject *object,
   switch (property_id)
     {
     case PROP_TEXT:
-      self->text = LR_TEXT (g_value_get_object (value));
+      g_clear_object (&self->text);
+      self->text = g_value_dup_object (value);
+      break;
+    case PROP_DATABASE:
+      self->db = g_value_get_object (value);
+      break;
+    case PROP_SEGMENTER:
+      g_clear_object (&self->segmenter);
+      self->segmenter = g_value_dup_object (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -131,7 +664,10 @@ lr_splitter_get_property (GObject *object, guint property_id, GValue *value, GPa
   switch (property_id)
     {
     case PROP_TEXT:
-      g_value_take_object (value, self->text);
+      g_value_set_object (value, self->text);
+      break;
+    case PROP_DATABASE:
+      g_value_set_object (value, self->db);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -153,6 +689,20 @@ lr_splitter_class_init (LrSplitterClass *klass)
                                                    LR_TYPE_TEXT,
                                                    G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
+  obj_properties[PROP_DATABASE] =
+    g_param_spec_object ("database",
+                         "Database",
+                         "The database caching the tokenization, or NULL.",
+                         LR_TYPE_DATABASE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  obj_properties[PROP_SEGMENTER] =
+    g_param_spec_object ("segmenter",
+                         "Segmenter",
+                         "The segmenter to split with instead of the language's, or NULL.",
+                         LR_TYPE_SEGMENTER,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY);
+
   g_object_class_install_properties (object_class, N_PROPERTIES, obj_properties);
 }
 
@@ -162,192 +712,455 @@ lr_splitter_new (LrText *text)
   return g_object_new (LR_TYPE_SPLITTER, "text", text, NULL);
 }
 
-const GArray *
-lr_splitter_get_words (LrSplitter *self)
+LrSplitter *
+lr_splitter_new_with_database (LrText *text, LrDatabase *db)
+{
+  return g_object_new (LR_TYPE_SPLITTER, "text", text, "database", db, NULL);
+}
+
+LrSplitter *
+lr_splitter_new_with_segmenter (LrText *text, LrSegmenter *segmenter)
+{
+  return g_object_new (LR_TYPE_SPLITTER, "text", text, "segmenter", segmenter, NULL);
+}
+
+gsize
+lr_splitter_get_memory_size (LrSplitter *self)
 {
   g_assert (LR_IS_SPLITTER (self));
 
-  return self->words;
+  /* Each range takes four guint32's: its start and length in bytes and in characters,
+   * and each word two more for its sentence and type */
+  return sizeof (LrSplitter) + (self->words.len + self->separators.len) * 4 * sizeof (guint32) +
+         self->words.len * 2 * sizeof (guint32) + self->n_types * 2 * sizeof (guint32) +
+         self->type_pool->allocated_len;
 }
 
-const lr_range_t *
-lr_splitter_get_word_at_index (LrSplitter *self, int index)
+int
+lr_splitter_get_n_words (LrSplitter *self)
 {
-  for (int i = 0; i < self->words->len; ++i)
-    {
-      lr_range_t *range = &g_array_index (self->words, lr_range_t, i);
-      if (index < range->start)
-        return NULL;
+  g_assert (LR_IS_SPLITTER (self));
 
-      if (index <= range->end)
-        return range;
-    }
-  return NULL;
+  return self->words.len;
 }
 
-GList *
-lr_splitter_ranges_from_string (LrSplitter *self, const gchar *range)
+void
+lr_splitter_get_word (LrSplitter *self, int index, lr_range_t *range)
 {
-  GList *list = NULL;
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (index >= 0 && (guint)index < self->words.len);
 
-  gchar **ranges = g_strsplit (range, ";", -1);
+  range_table_get (&self->words, index, range);
+}
 
-  for (int i = 0; ranges[i] != NULL; ++i)
+void
+lr_splitter_get_separator (LrSplitter *self, int index, lr_range_t *range)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (index >= 0 && (guint)index < self->separators.len);
+
+  range_table_get (&self->separators, index, range);
+}
+
+void
+lr_splitter_get_word_chars (LrSplitter *self, int index, lr_range_t *range)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (index >= 0 && (guint)index < self->words.len);
+
+  range->start = self->words.char_starts[index];
+  range->end = self->words.char_starts[index] + self->words.char_lengths[index];
+}
+
+void
+lr_splitter_get_separator_chars (LrSplitter *self, int index, lr_range_t *range)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (index >= 0 && (guint)index < self->separators.len);
+
+  range->start = self->separators.char_starts[index];
+  range->end = self->separators.char_starts[index] + self->separators.char_lengths[index];
+}
+
+int
+lr_splitter_get_n_sentences (LrSplitter *self)
+{
+  g_assert (LR_IS_SPLITTER (self));
+
+  /* The text after the last separator is a sentence too, even if empty */
+  return self->separators.len + 1;
+}
+
+void
+lr_splitter_get_sentence (LrSplitter *self, int index, lr_range_t *range)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (index >= 0 && (guint)index <= self->separators.len);
+
+  range->start = (index > 0) ? range_table_end (&self->separators, index - 1) : 0;
+  range->end = ((guint)index < self->separators.len) ? range_table_end (&self->separators, index)
+                                                       : self->text_length;
+}
+
+int
+lr_splitter_get_sentence_of_word (LrSplitter *self, int word)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (word >= 0 && (guint)word < self->words.len);
+
+  return self->word_sentences[word];
+}
+
+int
+lr_splitter_get_n_types (LrSplitter *self)
+{
+  g_assert (LR_IS_SPLITTER (self));
+
+  return self->n_types;
+}
+
+const guint32 *
+lr_splitter_get_word_types (LrSplitter *self)
+{
+  g_assert (LR_IS_SPLITTER (self));
+
+  return self->word_types;
+}
+
+guint32
+lr_splitter_get_word_type (LrSplitter *self, int word)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (word >= 0 && (guint)word < self->words.len);
+
+  return self->word_types[word];
+}
+
+const gchar *
+lr_splitter_get_type_form (LrSplitter *self, guint32 type)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (type < self->n_types);
+
+  return self->type_pool->str + self->type_offsets[type];
+}
+
+guint
+lr_splitter_get_type_count (LrSplitter *self, guint32 type)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (type < self->n_types);
+
+  return self->type_counts[type];
+}
+
+/*
+ * The word and separator tables are filled in the order the matches are
+ * found, so both are sorted by their start offsets, and since matches
+ * never overlap, by their end offsets as well. All the lookups below
+ * are binary searches over them.
+ */
+
+/* Returns the index of the first range that ends at or after the given offset */
+static guint
+first_range_ending_after (const range_table_t *ranges, guint32 offset)
+{
+  guint low = 0, high = ranges->len;
+  while (low < high)
     {
-      const gchar *string = ranges[i];
-      int word = g_ascii_strtoll (string, NULL, 10);
+      guint mid = low + (high - low) / 2;
+      if (range_table_end (ranges, mid) < offset)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+  return low;
+}
 
-      lr_range_t *range = &g_array_index (self->words, lr_range_t, word);
-      list = g_list_append (list, range);
+/* Returns the index of the first value in the sorted array at or after offset */
+static guint
+first_at_or_after (const guint32 *values, guint len, guint32 offset)
+{
+  guint low = 0, high = len;
+  while (low < high)
+    {
+      guint mid = low + (high - low) / 2;
+      if (values[mid] < offset)
+        low = mid + 1;
+      else
+        high = mid;
     }
+  return low;
+}
+
+/* Returns the index of the first range that starts at or after the given offset */
+static inline guint
+first_range_starting_after (const range_table_t *ranges, guint32 offset)
+{
+  return first_at_or_after (ranges->starts, ranges->len, offset);
+}
+
+/*
+ * The conversions start from the closest word at or before the offset,
+ * so they only have to count the characters of one word and the gap
+ * after it.
+ */
 
-  g_strfreev (ranges);
+int
+lr_splitter_byte_to_char_offset (LrSplitter *self, int byte_offset)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  const gchar *text = lr_text_get_text (self->text);
 
-  return list;
+  guint i = first_range_starting_after (&self->words, byte_offset + 1);
+  if (i == 0)
+    return g_utf8_pointer_to_offset (text, text + byte_offset);
+
+  const gchar *word = text + self->words.starts[i - 1];
+  return self->words.char_starts[i - 1] + g_utf8_pointer_to_offset (word, text + byte_offset);
 }
 
-static int
-word_index_from_range (LrSplitter *self, lr_range_t *range)
+int
+lr_splitter_char_to_byte_offset (LrSplitter *self, int char_offset)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  const gchar *text = lr_text_get_text (self->text);
+
+  guint i = first_at_or_after (self->words.char_starts, self->words.len, char_offset + 1);
+  if (i == 0)
+    return g_utf8_offset_to_pointer (text, char_offset) - text;
+
+  const gchar *word = text + self->words.starts[i - 1];
+  return g_utf8_offset_to_pointer (word, char_offset - self->words.char_starts[i - 1]) - text;
+}
+
+int
+lr_splitter_get_word_index_at_offset (LrSplitter *self, int offset)
 {
-  for (int i = 0; i < self->words->len; ++i)
+  g_assert (LR_IS_SPLITTER (self));
+
+  /* The word ending is inclusive so that clicking right after a word still selects it */
+  guint i = first_range_ending_after (&self->words, offset);
+  if (i == self->words.len)
+    return -1;
+
+  if ((guint32)offset < self->words.starts[i])
+    return -1;
+
+  return i;
+}
+
+int
+lr_splitter_get_word_index_from_range (LrSplitter *self, const lr_range_t *range)
+{
+  g_assert (LR_IS_SPLITTER (self));
+
+  guint i = first_range_starting_after (&self->words, range->start);
+  if (i == self->words.len)
+    return -1;
+
+  if (((int)self->words.starts[i] != range->start) ||
+      ((int)range_table_end (&self->words, i) != range->end))
+    return -1;
+
+  return i;
+}
+
+int
+lr_splitter_get_words_in_range (LrSplitter *self, const lr_range_t *range, int *first)
+{
+  g_assert (LR_IS_SPLITTER (self));
+  g_assert (range->start <= range->end);
+
+  /* The first word ending after the start, up to the first starting at or after the end */
+  guint i = first_range_ending_after (&self->words, range->start + 1);
+  guint j = first_range_starting_after (&self->words, range->end);
+
+  *first = i;
+  return (j > i) ? j - i : 0;
+}
+
+void
+lr_splitter_get_enclosing_separators (
+  LrSplitter *self, int start, int end, int *start_sep, int *end_sep)
+{
+  g_assert (LR_IS_SPLITTER (self));
+
+  /* The last separator ending at or before the start */
+  guint i = first_range_ending_after (&self->separators, start + 1);
+  *start_sep = (int)i - 1;
+
+  /* The first separator starting at or after the end */
+  i = first_range_starting_after (&self->separators, end);
+  *end_sep = (i < self->separators.len) ? (int)i : -1;
+}
+
+GArray *
+lr_splitter_words_from_bytes (LrSplitter *self, GBytes *bytes)
+{
+  gsize size;
+  const guint8 *data = g_bytes_get_data (bytes, &size);
+
+  /* Most indices take a single byte */
+  GArray *words = g_array_sized_new (FALSE, FALSE, sizeof (int), size);
+  if (!lr_word_list_decode (data, size, words))
+    g_warning ("Ignoring the corrupt end of a word list");
+
+  /* Drop the indices past the end of the text, which are sorted last */
+  while (words->len > 0 && (guint)g_array_index (words, int, words->len - 1) >= self->words.len)
     {
-      lr_range_t *current_range = &g_array_index (self->words, lr_range_t, i);
-      if (current_range == range)
-        return i;
+      g_warning ("Ignoring word %d, which is not in the text",
+                 g_array_index (words, int, words->len - 1));
+      g_array_set_size (words, words->len - 1);
     }
-  return -1;
+
+  return words;
 }
 
-gchar *
-lr_splitter_selection_to_text (LrSplitter *self, GList *selection)
+GBytes *
+lr_splitter_selection_to_bytes (LrSplitter *self, GArray *selection)
 {
-  int n_words = g_list_length (selection);
+  return lr_word_list_encode (selection);
+}
 
-  gchar **index_str_array = g_malloc ((n_words + 1) * sizeof (gchar *));
-  index_str_array[n_words] = NULL;
+GArray *
+lr_splitter_selection_to_ranges (LrSplitter *self, GArray *selection)
+{
+  GArray *ranges = g_array_sized_new (FALSE, FALSE, sizeof (lr_range_t), selection->len);
 
-  int i = 0;
-  for (GList *l = selection; l != NULL; l = l->next)
+  for (guint i = 0; i < selection->len; i++)
     {
-      lr_range_t *range = (lr_range_t *)l->data;
-      int word_index = word_index_from_range (self, range);
-      g_assert (word_index > -1);
-
-      index_str_array[i] = g_strdup_printf ("%d", word_index);
-      i++;
+      lr_range_t range;
+      lr_splitter_get_word (self, g_array_index (selection, int, i), &range);
+      g_array_append_val (ranges, range);
     }
 
-  gchar *joint = g_strjoinv (";", index_str_array);
-  g_strfreev (index_str_array);
-
-  return joint;
+  return ranges;
 }
 
 static gint
-compare_ranges (lr_range_t *first, lr_range_t *second)
+compare_indices (const int *first, const int *second)
 {
-  if (first->start < second->start)
-    return -1;
-  else if (first->start == second->start)
-    return 0;
-  else
-    return 1;
+  return *first - *second;
+}
+
+/*
+ * Appends the context of a sorted selection to buffer, with the words
+ * replaced by placeholder, followed by the words themselves. Everything is
+ * appended front to back, so the cost is linear in the length of the
+ * sentence.
+ */
+static void
+append_cloze (LrSplitter *self,
+              GArray *selection,
+              const gchar *placeholder,
+              GString *buffer,
+              lr_cloze_t *cloze)
+{
+  const gchar *text = lr_text_get_text (self->text);
+
+  /* The context runs from the sentence of the first word to that of the last one */
+  int first = g_array_index (selection, int, 0);
+  int last = g_array_index (selection, int, selection->len - 1);
+
+  lr_range_t sentence_range, last_sentence;
+  lr_splitter_get_sentence (self, self->word_sentences[first], &sentence_range);
+  lr_splitter_get_sentence (self, self->word_sentences[last], &last_sentence);
+  sentence_range.end = last_sentence.end;
+
+  /* Copy the sentence, with the placeholder in the place of each word */
+  cloze->context_offset = buffer->len;
+  int position = sentence_range.start;
+  for (guint i = 0; i < selection->len; i++)
+    {
+      lr_range_t word;
+      lr_splitter_get_word (self, g_array_index (selection, int, i), &word);
+
+      g_string_append_len (buffer, text + position, word.start - position);
+      g_string_append (buffer, placeholder);
+      position = word.end;
+    }
+  g_string_append_len (buffer, text + position, sentence_range.end - position);
+  cloze->context_length = buffer->len - cloze->context_offset;
+
+  /* Strip the whitespace around the context, as g_strstrip does */
+  while (cloze->context_length > 0 && g_ascii_isspace (buffer->str[cloze->context_offset]))
+    {
+      cloze->context_offset++;
+      cloze->context_length--;
+    }
+  while (cloze->context_length > 0 &&
+         g_ascii_isspace (buffer->str[cloze->context_offset + cloze->context_length - 1]))
+    cloze->context_length--;
+
+  /* The answer is the words joined with spaces */
+  cloze->answer_offset = buffer->len;
+  for (guint i = 0; i < selection->len; i++)
+    {
+      lr_range_t word;
+      lr_splitter_get_word (self, g_array_index (selection, int, i), &word);
+
+      if (i > 0)
+        g_string_append_c (buffer, ' ');
+      g_string_append_len (buffer, text + word.start, word.end - word.start);
+    }
+  cloze->answer_length = buffer->len - cloze->answer_offset;
 }
 
 /**
  * Creates a cloze-like question from an instance.
  *
  * Replaces the words in the sentence with placeholder and concantenates
- * all words with semicolons into answer. It sorts the selection_ptr list
+ * all words with spaces into answer. It sorts the selection array
  * as a side effect.
  */
 void
 lr_splitter_context_from_selection (LrSplitter *self,
-                                    GList **selection_ptr,
+                                    GArray *selection,
                                     gchar **context,
                                     gchar **answer,
                                     const gchar *placeholder)
 {
-  g_assert (selection_ptr != NULL);
-  g_assert (*selection_ptr != NULL);
+  g_assert (selection != NULL);
+  g_assert (selection->len > 0);
 
-  *selection_ptr = g_list_sort (*selection_ptr, (GCompareFunc)compare_ranges);
-  GList *selection = *selection_ptr;
+  g_array_sort (selection, (GCompareFunc)compare_indices);
 
-  /* Find the first and the last words in the selection */
-  lr_range_t *first = (lr_range_t *)selection->data, *last = (lr_range_t *)selection->data;
+  GString *buffer = g_string_new (NULL);
+  lr_cloze_t cloze;
+  append_cloze (self, selection, placeholder, buffer, &cloze);
 
-  for (GList *l = selection; l != NULL; l = l->next)
-    {
-      lr_range_t *range = (lr_range_t *)l->data;
+  *context = g_strndup (buffer->str + cloze.context_offset, cloze.context_length);
+  *answer = g_strndup (buffer->str + cloze.answer_offset, cloze.answer_length);
 
-      if (first->start > range->start)
-        first = range;
+  g_string_free (buffer, TRUE);
+}
 
-      if (last->end < range->end)
-        last = range;
-    }
+void
+lr_splitter_clozes_from_selections (LrSplitter *self,
+                                    GPtrArray *selections,
+                                    const gchar *placeholder,
+                                    GString *buffer,
+                                    GArray *clozes)
+{
+  g_assert (LR_IS_SPLITTER (self));
 
-  const gchar *text = lr_text_get_text (self->text);
+  g_array_set_size (clozes, selections->len);
 
-  /* Find the first separator before the first word and first after the last word */
-  lr_range_t *start_sep = NULL;
-  lr_range_t *end_sep = NULL;
-  for (int i = 0; i < self->separators->len; i++)
+  for (guint i = 0; i < selections->len; i++)
     {
-      lr_range_t *sep = &g_array_index (self->separators, lr_range_t, i);
+      GArray *selection = g_ptr_array_index (selections, i);
+      lr_cloze_t *cloze = &g_array_index (clozes, lr_cloze_t, i);
 
-      /* If the separator is before the word, set it as the start separator */
-      if (sep->end <= first->start)
-        start_sep = sep;
-
-      /* If no end separator has been set, and this one is after the last word,
-       * set it as the end separator, and also exit the loop */
-      if (!end_sep && (sep->start >= last->end))
+      if (selection->len == 0)
         {
-          end_sep = sep;
-          break;
+          cloze->context_offset = cloze->answer_offset = buffer->len;
+          cloze->context_length = cloze->answer_length = 0;
+          continue;
         }
-    }
 
-  lr_range_t sentence_range;
-  if (start_sep)
-    sentence_range.start = start_sep->end;
-  else
-    sentence_range.start = 0;
-
-  if (end_sep)
-    sentence_range.end = end_sep->end;
-  else
-    sentence_range.end = strlen (text);
-
-  GString *sentence_str =
-    g_string_new_len (text + sentence_range.start, sentence_range.end - sentence_range.start);
-
-  GString *answer_str = g_string_new (NULL);
-
-  /* Substitute the words for the placeholder */
-  /* When deleting a word and substituting it with the placeholder, the range offsets will be invalid.
-   * Therefore, the following offset is updated as offset += strlen(placeholder) - strlen(word) */
-  int placeholder_len = strlen (placeholder);
-  int offset = 0;
-  for (GList *l = selection; l != NULL; l = l->next)
-    {
-      lr_range_t *range = (lr_range_t *)l->data;
-
-      g_string_erase (
-        sentence_str, offset + range->start - sentence_range.start, range->end - range->start);
-      g_string_insert (sentence_str, offset + range->start - sentence_range.start, placeholder);
-
-      offset += placeholder_len - (range->end - range->start);
-
-      if (answer_str->len)
-        g_string_append_c (answer_str, ' ');
-
-      g_string_append_len (answer_str, text + range->start, range->end - range->start);
+      g_array_sort (selection, (GCompareFunc)compare_indices);
+      append_cloze (self, selection, placeholder, buffer, cloze);
     }
-
-  *context = g_strstrip (g_string_free (sentence_str, FALSE));
-  *answer = g_string_free (answer_str, FALSE);
 }
 
@@ -22,6 +22,8 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "lr-text.h"
+#include "lr-database.h"
+#include "lr-segmenter.h"
 
 G_BEGIN_DECLS
 
@@ -35,15 +37,113 @@ G_DECLARE_FINAL_TYPE (LrSplitter, lr_splitter, LR, SPLITTER, GObject)
 
 LrSplitter *lr_splitter_new (LrText *text);
 
-const GArray *lr_splitter_get_words (LrSplitter *self);
+/* Like lr_splitter_new, but loads the word and separator ranges from the
+ * tokenization cached in the database if it is still valid, and caches
+ * them otherwise. */
+LrSplitter *lr_splitter_new_with_database (LrText *text, LrDatabase *db);
 
-const lr_range_t *lr_splitter_get_word_at_index (LrSplitter *self, int index);
+/* Like lr_splitter_new, but segments the words with the given segmenter
+ * instead of the language's, e.g. one it had before an update */
+LrSplitter *lr_splitter_new_with_segmenter (LrText *text, LrSegmenter *segmenter);
 
-GList *lr_splitter_ranges_from_string (LrSplitter *self, const gchar *range);
-gchar *lr_splitter_selection_to_text (LrSplitter *self, GList *selection);
+/* Returns a value identifying how texts of the language are split, which
+ * changes whenever its regexes, abbreviations or segmenter do */
+gint64 lr_splitter_get_tokenization_version (LrLanguage *language);
 
-void lr_splitter_context_from_selection (
-  LrSplitter *self, GList **selection, gchar **context, gchar **answer, const gchar *placeholder);
+/* Returns how many bytes of memory the splitter holds */
+gsize lr_splitter_get_memory_size (LrSplitter *self);
+
+/*
+ * Words and separators are referred to by their index in the text. The
+ * ranges are returned by value, in bytes unless stated otherwise.
+ */
+
+int lr_splitter_get_n_words (LrSplitter *self);
+void lr_splitter_get_word (LrSplitter *self, int index, lr_range_t *range);
+void lr_splitter_get_separator (LrSplitter *self, int index, lr_range_t *range);
+
+/* Sentences run up to and including a separator, or the end of the text */
+int lr_splitter_get_n_sentences (LrSplitter *self);
+void lr_splitter_get_sentence (LrSplitter *self, int index, lr_range_t *range);
+int lr_splitter_get_sentence_of_word (LrSplitter *self, int word);
+
+/*
+ * Words with the same case-folded form share a type, numbered from zero
+ * in the order they first occur in the text.
+ */
+
+int lr_splitter_get_n_types (LrSplitter *self);
+
+/* Returns the type of each word, as an array of lr_splitter_get_n_words elements */
+const guint32 *lr_splitter_get_word_types (LrSplitter *self);
+guint32 lr_splitter_get_word_type (LrSplitter *self, int word);
+
+/* Returns the case-folded form of the type */
+const gchar *lr_splitter_get_type_form (LrSplitter *self, guint32 type);
+
+/* Returns how many times the type occurs in the text */
+guint lr_splitter_get_type_count (LrSplitter *self, guint32 type);
+
+/* Get the range of the word or separator at index in character offsets */
+void lr_splitter_get_word_chars (LrSplitter *self, int index, lr_range_t *range);
+void lr_splitter_get_separator_chars (LrSplitter *self, int index, lr_range_t *range);
+
+/* Convert between byte and character offsets into the text in O(log n) */
+int lr_splitter_byte_to_char_offset (LrSplitter *self, int byte_offset);
+int lr_splitter_char_to_byte_offset (LrSplitter *self, int char_offset);
+
+/* Returns the index of the word containing the given byte offset, or -1 */
+int lr_splitter_get_word_index_at_offset (LrSplitter *self, int offset);
+
+/* Returns the index of the word with the given range, or -1 if it is not a word */
+int lr_splitter_get_word_index_from_range (LrSplitter *self, const lr_range_t *range);
+
+/* Returns how many words overlap the byte range, and sets first to the
+ * index of the first of them. If there are none, first is the index of the
+ * word after the range (which may be the number of words).
+ */
+int lr_splitter_get_words_in_range (LrSplitter *self, const lr_range_t *range, int *first);
+
+/* Finds the index of the last separator ending before start and of the first one
+ * starting after end. Either one is set to -1 if there is no such separator.
+ */
+void lr_splitter_get_enclosing_separators (
+  LrSplitter *self, int start, int end, int *start_sep, int *end_sep);
+
+/*
+ * Selections are GArrays of word indices (int), stored in the database
+ * encoded as described in lr-word-list.h.
+ */
+
+GArray *lr_splitter_words_from_bytes (LrSplitter *self, GBytes *bytes);
+GBytes *lr_splitter_selection_to_bytes (LrSplitter *self, GArray *selection);
+
+/* Returns a GArray of the lr_range_t's of the selected words */
+GArray *lr_splitter_selection_to_ranges (LrSplitter *self, GArray *selection);
+
+/* A cloze question, as offsets into the buffer it was generated into */
+typedef struct
+{
+  gsize context_offset, context_length;
+  gsize answer_offset, answer_length;
+} lr_cloze_t;
+
+/* Generates the cloze of each selection (a GArray of word indices) of
+ * selections, appending their contexts and answers to buffer and filling
+ * clozes, an array of lr_cloze_t, with their offsets in the same order.
+ * Sorts the selections as a side effect.
+ */
+void lr_splitter_clozes_from_selections (LrSplitter *self,
+                                         GPtrArray *selections,
+                                         const gchar *placeholder,
+                                         GString *buffer,
+                                         GArray *clozes);
+
+void lr_splitter_context_from_selection (LrSplitter *self,
+                                         GArray *selection,
+                                         gchar **context,
+                                         gchar **answer,
+                                         const gchar *placeholder);
 
 G_END_DECLS
 
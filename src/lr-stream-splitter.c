@@ -0,0 +1,502 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-stream-splitter.h"
+#include "lr-char-class.h"
+#include "lr-preset-classes.h"
+#include "lr-regex-cache.h"
+#include "lr-segmenter.h"
+#include "lr-sentence-detector.h"
+
+/* How much is read from the stream at a time */
+#define CHUNK_SIZE (64 * 1024)
+
+/* How many bytes are kept before the scanning position, so that
+ * lookbehind assertions and abbreviations are seen as in one piece */
+#define HISTORY_SIZE 64
+
+struct _LrStreamSplitter
+{
+  GObject parent_instance;
+
+  LrLanguage *language;
+
+  /* Only one of the two is set, as in LrSplitter */
+  const lr_char_class_t *word_class;
+  GRegex *word_regex;
+
+  /* The word class, when it isn't one of the presets' */
+  lr_char_class_t *parsed_class;
+
+  /* Only one of the two is set, as in LrSplitter */
+  lr_sentence_detector_t *detector;
+  GRegex *separator_regex;
+
+  /* Splits the word runs further, or NULL */
+  LrSegmenter *segmenter;
+};
+
+enum
+{
+  PROP_0,
+  PROP_LANGUAGE,
+  N_PROPERTIES
+};
+
+static GParamSpec *obj_properties[N_PROPERTIES] = {
+  NULL,
+};
+
+G_DEFINE_TYPE (LrStreamSplitter, lr_stream_splitter, G_TYPE_OBJECT)
+
+/* The part of the text currently in memory */
+typedef struct
+{
+  GByteArray *buffer;
+
+  /* Offset of the first byte of the buffer in the text */
+  gsize buffer_offset;
+
+  /* Length of the buffer up to the last complete UTF-8 character */
+  gsize available;
+
+  gboolean eof;
+
+  lr_range_func_t word_func;
+  lr_range_func_t sentence_func;
+  gpointer user_data;
+
+  LrSegmenter *segmenter;
+  GArray *segments;
+
+  /* Where the sentence being read started */
+  gsize sentence_start;
+} split_state_t;
+
+typedef void (*emit_func_t) (const lr_range_t *range, split_state_t *state);
+
+static void
+emit_word (const lr_range_t *range, split_state_t *state)
+{
+  if (!state->word_func)
+    return;
+
+  if (!state->segmenter)
+    {
+      state->word_func (range, state->user_data);
+      return;
+    }
+
+  /* Words are complete once found, so they are still in the buffer */
+  const gchar *run = (const gchar *)state->buffer->data + (range->start - state->buffer_offset);
+  g_array_set_size (state->segments, 0);
+  lr_segmenter_segment (
+    state->segmenter, run, range->end - range->start, range->start, state->segments);
+
+  for (guint i = 0; i < state->segments->len; i++)
+    state->word_func (&g_array_index (state->segments, lr_range_t, i), state->user_data);
+}
+
+static void
+emit_separator (const lr_range_t *range, split_state_t *state)
+{
+  lr_range_t sentence = { state->sentence_start, range->end };
+  state->sentence_start = range->end;
+
+  if (state->sentence_func)
+    state->sentence_func (&sentence, state->user_data);
+}
+
+static void
+lr_stream_splitter_init (LrStreamSplitter *self)
+{
+}
+
+static void
+lr_stream_splitter_constructed (GObject *object)
+{
+  LrStreamSplitter *self = LR_STREAM_SPLITTER (object);
+  g_assert (LR_IS_LANGUAGE (self->language));
+
+  const gchar *word_regex_string = lr_language_get_word_regex (self->language);
+  self->word_class = lr_preset_class_lookup (word_regex_string);
+  if (!self->word_class)
+    self->word_class = self->parsed_class = lr_char_class_new_from_regex (word_regex_string);
+
+  if (!self->word_class)
+    {
+      self->word_regex =
+        lr_regex_cache_lookup (lr_language_get_id (self->language), word_regex_string);
+    }
+
+  self->detector = lr_sentence_detector_new (lr_language_get_abbreviations (self->language));
+  if (!self->detector)
+    {
+      self->separator_regex = lr_regex_cache_lookup (
+        lr_language_get_id (self->language), lr_language_get_separator_regex (self->language));
+    }
+
+  self->segmenter = lr_segmenter_new_for_language (lr_language_get_code (self->language));
+
+  G_OBJECT_CLASS (lr_stream_splitter_parent_class)->constructed (object);
+}
+
+static void
+lr_stream_splitter_finalize (GObject *object)
+{
+  LrStreamSplitter *self = LR_STREAM_SPLITTER (object);
+
+  lr_char_class_free (self->parsed_class);
+  g_clear_pointer (&self->word_regex, g_regex_unref);
+  lr_sentence_detector_free (self->detector);
+  g_clear_pointer (&self->separator_regex, g_regex_unref);
+  g_clear_object (&self->segmenter);
+  g_clear_object (&self->language);
+
+  G_OBJECT_CLASS (lr_stream_splitter_parent_class)->finalize (object);
+}
+
+static void
+lr_stream_splitter_set_property (GObject *object,
+                                 guint property_id,
+                                 const GValue *value,
+                                 GParamSpec *pspec)
+{
+  LrStreamSplitter *self = LR_STREAM_SPLITTER (object);
+
+  switch (property_id)
+    {
+    case PROP_LANGUAGE:
+      g_clear_object (&self->language);
+      self->language = g_value_dup_object (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+lr_stream_splitter_get_property (GObject *object,
+                                 guint property_id,
+                                 GValue *value,
+                                 GParamSpec *pspec)
+{
+  LrStreamSplitter *self = LR_STREAM_SPLITTER (object);
+
+  switch (property_id)
+    {
+    case PROP_LANGUAGE:
+      g_value_set_object (value, self->language);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+lr_stream_splitter_class_init (LrStreamSplitterClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  object_class->constructed = lr_stream_splitter_constructed;
+  object_class->finalize = lr_stream_splitter_finalize;
+  object_class->set_property = lr_stream_splitter_set_property;
+  object_class->get_property = lr_stream_splitter_get_property;
+
+  obj_properties[PROP_LANGUAGE] =
+    g_param_spec_object ("language",
+                         "Language",
+                         "The language whose regexes split the text.",
+                         LR_TYPE_LANGUAGE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  g_object_class_install_properties (object_class, N_PROPERTIES, obj_properties);
+}
+
+LrStreamSplitter *
+lr_stream_splitter_new (LrLanguage *language)
+{
+  return g_object_new (LR_TYPE_STREAM_SPLITTER, "language", language, NULL);
+}
+
+/* Returns the length of data without a trailing incomplete UTF-8 character */
+static gsize
+complete_prefix_length (const guint8 *data, gsize length)
+{
+  /* Find the start of the last character */
+  gsize lead = length;
+  int n_continuation = 0;
+  while (lead > 0 && n_continuation < 4 && (data[lead - 1] & 0xC0) == 0x80)
+    {
+      lead--;
+      n_continuation++;
+    }
+
+  if (lead == 0)
+    return length; /* Not UTF-8 anyway */
+
+  guint8 byte = data[lead - 1];
+  int expected = 1;
+  if (byte >= 0xF0)
+    expected = 4;
+  else if (byte >= 0xE0)
+    expected = 3;
+  else if (byte >= 0xC0)
+    expected = 2;
+
+  if (n_continuation + 1 < expected)
+    return lead - 1;
+
+  return length;
+}
+
+/*
+ * All scanners report the ranges that can't change anymore no matter
+ * what follows in the stream, and move the position up to where scanning
+ * has to resume once more text is read.
+ */
+
+static void
+scan_char_class (const lr_char_class_t *klass,
+                 split_state_t *state,
+                 gsize *position,
+                 GArray *scratch,
+                 emit_func_t emit)
+{
+  gsize offset = *position - state->buffer_offset;
+  const gchar *data = (const gchar *)state->buffer->data + offset;
+
+  g_array_set_size (scratch, 0);
+  lr_char_class_split (klass, data, state->available - offset, scratch);
+
+  *position = state->buffer_offset + state->available;
+  for (guint i = 0; i < scratch->len; i++)
+    {
+      lr_range_t range = g_array_index (scratch, lr_range_t, i);
+      range.start += *position - (state->available - offset);
+      range.end += *position - (state->available - offset);
+
+      /* A word running into the end of the buffer may go on in the next chunk */
+      if (!state->eof && (gsize)range.end == *position)
+        {
+          *position = range.start;
+          break;
+        }
+
+      emit (&range, state);
+    }
+}
+
+static void
+scan_sentences (lr_sentence_detector_t *detector,
+                split_state_t *state,
+                gsize *position,
+                GArray *scratch,
+                emit_func_t emit)
+{
+  /* The history before the position lets the detector see the abbreviations */
+  g_array_set_size (scratch, 0);
+  lr_sentence_detector_split (detector,
+                              (const gchar *)state->buffer->data,
+                              *position - state->buffer_offset,
+                              state->available,
+                              scratch);
+
+  *position = state->buffer_offset + state->available;
+  for (guint i = 0; i < scratch->len; i++)
+    {
+      lr_range_t range = g_array_index (scratch, lr_range_t, i);
+      range.start += state->buffer_offset;
+      range.end += state->buffer_offset;
+
+      /* More punctuation or whitespace may follow in the next chunk */
+      if (!state->eof && (gsize)range.end == *position)
+        {
+          *position = range.start;
+          break;
+        }
+
+      emit (&range, state);
+    }
+}
+
+static gboolean
+scan_regex (GRegex *regex, split_state_t *state, gsize *position, emit_func_t emit, GError **error)
+{
+  /* A regex which doesn't compile matches nothing */
+  if (!regex)
+    {
+      *position = state->buffer_offset + state->available;
+      return TRUE;
+    }
+
+  const gchar *data = (const gchar *)state->buffer->data;
+
+  /* A partial match at the end of the buffer is reported instead of any shorter
+   * complete match, and scanning resumes from its start once more text is read. */
+  GRegexMatchFlags flags = 0;
+  if (!state->eof)
+    flags |= G_REGEX_MATCH_PARTIAL_HARD | G_REGEX_MATCH_NOTEOL;
+  if (state->buffer_offset > 0)
+    flags |= G_REGEX_MATCH_NOTBOL;
+
+  GMatchInfo *match_info;
+  GError *match_error = NULL;
+  g_regex_match_full (regex,
+                      data,
+                      state->available,
+                      *position - state->buffer_offset,
+                      flags,
+                      &match_info,
+                      &match_error);
+
+  while (g_match_info_matches (match_info))
+    {
+      int start, end;
+      g_match_info_fetch_pos (match_info, 0, &start, &end);
+
+      lr_range_t range = { state->buffer_offset + start, state->buffer_offset + end };
+      emit (&range, state);
+
+      g_match_info_next (match_info, &match_error);
+    }
+
+  if (g_match_info_is_partial_match (match_info))
+    {
+      int start, end;
+      g_match_info_fetch_pos (match_info, 0, &start, &end);
+      *position = state->buffer_offset + start;
+    }
+  else
+    {
+      *position = state->buffer_offset + state->available;
+    }
+
+  g_match_info_free (match_info);
+
+  if (match_error)
+    {
+      g_propagate_error (error, match_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+gboolean
+lr_stream_splitter_split (LrStreamSplitter *self,
+                          GInputStream *stream,
+                          lr_range_func_t word_func,
+                          lr_range_func_t sentence_func,
+                          gpointer user_data,
+                          GCancellable *cancellable,
+                          GError **error)
+{
+  g_assert (LR_IS_STREAM_SPLITTER (self));
+  g_assert (G_IS_INPUT_STREAM (stream));
+
+  split_state_t state;
+  state.buffer = g_byte_array_sized_new (CHUNK_SIZE + HISTORY_SIZE);
+  state.buffer_offset = 0;
+  state.available = 0;
+  state.eof = FALSE;
+  state.word_func = word_func;
+  state.sentence_func = sentence_func;
+  state.user_data = user_data;
+  state.sentence_start = 0;
+  state.segmenter = self->segmenter;
+  state.segments = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+
+  GArray *scratch = g_array_new (FALSE, FALSE, sizeof (lr_range_t));
+
+  gsize word_position = 0;
+  gsize separator_position = 0;
+  gboolean success = TRUE;
+
+  while (success && !state.eof)
+    {
+      /* Append the next chunk to whatever is still needed from the previous ones */
+      guint old_length = state.buffer->len;
+      g_byte_array_set_size (state.buffer, old_length + CHUNK_SIZE);
+
+      gssize n_read = g_input_stream_read (
+        stream, state.buffer->data + old_length, CHUNK_SIZE, cancellable, error);
+      if (n_read < 0)
+        {
+          success = FALSE;
+          break;
+        }
+
+      g_byte_array_set_size (state.buffer, old_length + n_read);
+      state.eof = n_read == 0;
+
+      if (state.eof)
+        state.available = state.buffer->len;
+      else
+        state.available = complete_prefix_length (state.buffer->data, state.buffer->len);
+
+      if (word_func)
+        {
+          if (self->word_class)
+            scan_char_class (self->word_class, &state, &word_position, scratch, emit_word);
+          else
+            success = scan_regex (self->word_regex, &state, &word_position, emit_word, error);
+        }
+
+      if (success && sentence_func)
+        {
+          if (self->detector)
+            scan_sentences (self->detector, &state, &separator_position, scratch, emit_separator);
+          else
+            success = scan_regex (
+              self->separator_regex, &state, &separator_position, emit_separator, error);
+        }
+
+      /* Drop the text both scanners are done with, except for a little history */
+      gsize position = state.buffer_offset + state.available;
+      if (word_func)
+        position = MIN (position, word_position);
+      if (sentence_func)
+        position = MIN (position, separator_position);
+
+      gsize keep_from = state.buffer_offset;
+      if (position > state.buffer_offset + HISTORY_SIZE)
+        keep_from = position - HISTORY_SIZE;
+
+      /* Never cut a character in half */
+      while (keep_from < position &&
+             (state.buffer->data[keep_from - state.buffer_offset] & 0xC0) == 0x80)
+        keep_from++;
+
+      g_byte_array_remove_range (state.buffer, 0, keep_from - state.buffer_offset);
+      state.buffer_offset = keep_from;
+    }
+
+  /* The last sentence may not end in a separator */
+  gsize text_length = state.buffer_offset + state.buffer->len;
+  if (success && sentence_func && state.sentence_start < text_length)
+    {
+      lr_range_t sentence = { state.sentence_start, text_length };
+      sentence_func (&sentence, user_data);
+    }
+
+  g_array_free (scratch, TRUE);
+  g_array_free (state.segments, TRUE);
+  g_byte_array_free (state.buffer, TRUE);
+
+  return success;
+}
@@ -0,0 +1,58 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_stream_splitter_h
+#define _lr_stream_splitter_h
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include "lr-language.h"
+#include "lr-splitter.h"
+
+G_BEGIN_DECLS
+
+typedef void (*lr_range_func_t) (const lr_range_t *range, gpointer user_data);
+
+#define LR_TYPE_STREAM_SPLITTER (lr_stream_splitter_get_type ())
+G_DECLARE_FINAL_TYPE (LrStreamSplitter, lr_stream_splitter, LR, STREAM_SPLITTER, GObject)
+
+/*
+ * Splits texts the same way LrSplitter does, but reads them in chunks from
+ * a GInputStream and reports the ranges as soon as they are known, without
+ * ever holding more than a chunk (plus the word or separator being matched)
+ * in memory.
+ */
+LrStreamSplitter *lr_stream_splitter_new (LrLanguage *language);
+
+/* Splits the text read from stream, calling word_func with each word and
+ * sentence_func with each sentence, that is the text up to and including
+ * a separator (or the end of the text). Either function may be NULL.
+ * Returns FALSE and sets error if reading the stream failed.
+ */
+gboolean lr_stream_splitter_split (LrStreamSplitter *self,
+                                   GInputStream *stream,
+                                   lr_range_func_t word_func,
+                                   lr_range_func_t sentence_func,
+                                   gpointer user_data,
+                                   GCancellable *cancellable,
+                                   GError **error);
+
+G_END_DECLS
+
+#endif /* _lr_stream_splitter_h */
@@ -27,6 +27,8 @@ G_BEGIN_DECLS
 #define LR_TYPE_TEXT_DIALOG (lr_text_dialog_get_type ())
 G_DECLARE_FINAL_TYPE (LrTextDialog, lr_text_dialog, LR, TEXT_DIALOG, GtkDialog)
 
+/* The dialog writes the edits into the text on OK, so texts which have
+ * been split must be edited through a copy */
 GtkWidget *lr_text_dialog_new (LrText *text);
 
 void lr_text_dialog_set_text (LrTextDialog *self, LrText *text);
@@ -101,7 +101,15 @@ edit_text_cb (LrTextSelector *self, GtkWidget *button)
   if (lr_text_get_text (self->selected_text) == NULL)
     lr_database_load_text (self->db, self->selected_text);
 
-  GtkWidget *text_dialog = lr_text_dialog_new (self->selected_text);
+  /* Edit a copy, the cached splitters and the reader hold the text with
+   * the ranges of its stored contents until the database is updated */
+  LrText *edited = lr_text_new (lr_text_get_id (self->selected_text),
+                                lr_text_get_language (self->selected_text),
+                                lr_text_get_title (self->selected_text),
+                                lr_text_get_tags (self->selected_text));
+  lr_text_set_text (edited, lr_text_get_text (self->selected_text));
+
+  GtkWidget *text_dialog = lr_text_dialog_new (edited);
 
   gchar *title = g_strdup_printf ("Edit text '%s'", lr_text_get_title (self->selected_text));
   gtk_window_set_title (GTK_WINDOW (text_dialog), title);
@@ -114,12 +122,15 @@ edit_text_cb (LrTextSelector *self, GtkWidget *button)
 
   gtk_widget_destroy (text_dialog);
 
+  /* The list is repopulated with new texts, so the views read the new contents */
   if (response == GTK_RESPONSE_OK)
     {
-      lr_database_update_text (self->db, self->selected_text);
+      lr_database_update_text (self->db, edited);
       populate_text_list (self);
       g_signal_emit (self, obj_signals[TEXT_MODIFIED], 0);
     }
+
+  g_object_unref (edited);
 }
 
 static void
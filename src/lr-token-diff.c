@@ -0,0 +1,150 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-token-diff.h"
+
+static void
+map_range (GArray *map, int old_start, int old_end, int new_start, gboolean kept)
+{
+  for (int i = old_start; i < old_end; i++)
+    {
+      lr_token_map_t *entry = &g_array_index (map, lr_token_map_t, i);
+      entry->index = kept ? new_start + (i - old_start) : new_start;
+      entry->kept = kept;
+    }
+}
+
+/*
+ * The greedy forward pass keeps, for every number of edits d, the furthest
+ * x reached on each diagonal k = x - y in [-d, d]. Only every other
+ * diagonal is reachable, so the d'th row of the trace has d + 1 entries
+ * and starts at d (d + 1) / 2.
+ */
+
+#define ROW(d) ((gsize) (d) * ((d) + 1) / 2)
+#define TRACE(trace, d, k) (trace)[ROW (d) + ((k) + (d)) / 2]
+
+/* Returns the number of edits, or -1 if there are more than max_edits */
+static int
+myers_forward (const guint32 *a, int n, const guint32 *b, int m, int max_edits, GArray *trace)
+{
+  for (int d = 0; d <= max_edits; d++)
+    {
+      g_array_set_size (trace, ROW (d + 1));
+      int *v = (int *)trace->data;
+
+      for (int k = -d; k <= d; k += 2)
+        {
+          int x;
+          if (d == 0)
+            x = 0;
+          else if (k == -d || (k != d && TRACE (v, d - 1, k - 1) < TRACE (v, d - 1, k + 1)))
+            x = TRACE (v, d - 1, k + 1); /* Insertion, down from k + 1 */
+          else
+            x = TRACE (v, d - 1, k - 1) + 1; /* Deletion, right from k - 1 */
+
+          int y = x - k;
+          while (x < n && y < m && a[x] == b[y])
+            x++, y++;
+
+          TRACE (v, d, k) = x;
+          if (x >= n && y >= m)
+            return d;
+        }
+    }
+
+  return -1;
+}
+
+/* Walks the trace back from the end, filling the map of the middle */
+static void
+myers_backtrack (GArray *map, int offset, int new_offset, int n, int m, int edits, GArray *trace)
+{
+  const int *v = (const int *)trace->data;
+  int x = n, y = m;
+
+  for (int d = edits; d > 0; d--)
+    {
+      int k = x - y;
+      int prev_k;
+      if (k == -d || (k != d && TRACE (v, d - 1, k - 1) < TRACE (v, d - 1, k + 1)))
+        prev_k = k + 1;
+      else
+        prev_k = k - 1;
+
+      int prev_x = TRACE (v, d - 1, prev_k);
+      int prev_y = prev_x - prev_k;
+
+      /* The snake after the edit */
+      int snake = (prev_k == k + 1) ? x - prev_x : y - prev_y;
+      map_range (map, offset + x - snake, offset + x, new_offset + y - snake, TRUE);
+      x -= snake;
+      y -= snake;
+
+      if (prev_k == k - 1)
+        {
+          /* Deleted a[x - 1] */
+          map_range (map, offset + x - 1, offset + x, new_offset + y, FALSE);
+          x--;
+        }
+      else
+        {
+          /* Inserted b[y - 1] */
+          y--;
+        }
+    }
+
+  /* The snake from the origin */
+  map_range (map, offset, offset + x, new_offset, TRUE);
+}
+
+GArray *
+lr_token_diff (const guint32 *old, int n_old, const guint32 *new, int n_new)
+{
+  GArray *map = g_array_sized_new (FALSE, FALSE, sizeof (lr_token_map_t), n_old);
+  g_array_set_size (map, n_old);
+
+  int prefix = 0;
+  while (prefix < n_old && prefix < n_new && old[prefix] == new[prefix])
+    prefix++;
+
+  int suffix = 0;
+  while (suffix < n_old - prefix && suffix < n_new - prefix &&
+         old[n_old - suffix - 1] == new[n_new - suffix - 1])
+    suffix++;
+
+  map_range (map, 0, prefix, 0, TRUE);
+  map_range (map, n_old - suffix, n_old, n_new - suffix, TRUE);
+
+  int n = n_old - prefix - suffix;
+  int m = n_new - prefix - suffix;
+  if (n == 0)
+    return map;
+
+  GArray *trace = g_array_new (FALSE, FALSE, sizeof (int));
+  int max_edits = MIN (n + m, LR_TOKEN_DIFF_MAX_EDITS);
+  int edits = myers_forward (old + prefix, n, new + prefix, m, max_edits, trace);
+
+  if (edits >= 0)
+    myers_backtrack (map, prefix, prefix, n, m, edits, trace);
+  else
+    map_range (map, prefix, prefix + n, prefix, FALSE);
+
+  g_array_free (trace, TRUE);
+  return map;
+}
@@ -0,0 +1,50 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_token_diff_h
+#define _lr_token_diff_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Where a token of the old sequence ended up in the new one */
+typedef struct
+{
+  /* The index of the token in the new sequence. For a deleted token, the
+   * index of the new token at the place it was deleted from, which may be
+   * the length of the new sequence. */
+  int index;
+  gboolean kept;
+} lr_token_map_t;
+
+/*
+ * Diffs two token sequences with Myers' algorithm, after stripping their
+ * common prefix and suffix. It takes O((N + M) D) time for D edits, so
+ * small edits in long texts stay cheap. Past LR_TOKEN_DIFF_MAX_EDITS the
+ * remaining middle of the old sequence is reported as deleted.
+ *
+ * Returns an array of n_old lr_token_map_t's.
+ */
+#define LR_TOKEN_DIFF_MAX_EDITS 2048
+
+GArray *lr_token_diff (const guint32 *old, int n_old, const guint32 *new, int n_new);
+
+G_END_DECLS
+
+#endif /* _lr_token_diff_h */
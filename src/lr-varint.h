@@ -0,0 +1,81 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_varint_h
+#define _lr_varint_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * LEB128 style variable length integers: seven bits per byte, least
+ * significant group first, with the high bit set on all but the last byte.
+ * Small values, such as the deltas between consecutive word offsets, take
+ * a single byte.
+ */
+
+static inline void
+lr_varint_append (GByteArray *array, guint32 value)
+{
+  guint8 buffer[5];
+  guint length = 0;
+
+  while (value >= 0x80)
+    {
+      buffer[length++] = (value & 0x7F) | 0x80;
+      value >>= 7;
+    }
+  buffer[length++] = value;
+
+  g_byte_array_append (array, buffer, length);
+}
+
+/* Reads a varint at *ptr and advances it. Returns FALSE if the data is
+ * truncated or the value does not fit in 32 bits.
+ */
+static inline gboolean
+lr_varint_read (const guint8 **ptr, const guint8 *end, guint32 *value)
+{
+  const guint8 *p = *ptr;
+  guint32 result = 0;
+
+  for (guint shift = 0; shift < 35; shift += 7)
+    {
+      if (p == end)
+        return FALSE;
+
+      guint8 byte = *p++;
+      if (shift == 28 && byte > 0x0F)
+        return FALSE;
+
+      result |= (guint32)(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        {
+          *ptr = p;
+          *value = result;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+G_END_DECLS
+
+#endif /* _lr_varint_h */
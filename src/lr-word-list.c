@@ -0,0 +1,105 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lr-word-list.h"
+#include "lr-varint.h"
+#include <string.h>
+
+static gint
+compare_indices (const int *first, const int *second)
+{
+  return *first - *second;
+}
+
+GBytes *
+lr_word_list_encode (GArray *words)
+{
+  /* Sort a copy, since the caller's order may matter to them */
+  int *sorted = g_new (int, words->len);
+  memcpy (sorted, words->data, words->len * sizeof (int));
+  g_qsort_with_data (sorted, words->len, sizeof (int), (GCompareDataFunc)compare_indices, NULL);
+
+  GByteArray *bytes = g_byte_array_sized_new (words->len);
+
+  int previous = 0;
+  for (guint i = 0; i < words->len; i++)
+    {
+      /* The indices can come from a corrupt row, which shouldn't take the
+       * rest of the database down with it */
+      if (sorted[i] < 0)
+        {
+          g_warning ("Dropping the negative word index %d", sorted[i]);
+          continue;
+        }
+
+      lr_varint_append (bytes, sorted[i] - previous);
+      previous = sorted[i];
+    }
+
+  g_free (sorted);
+
+  return g_byte_array_free_to_bytes (bytes);
+}
+
+gboolean
+lr_word_list_decode (const guint8 *data, gsize size, GArray *words)
+{
+  const guint8 *end = data + size;
+
+  guint32 word = 0;
+  while (data < end)
+    {
+      guint32 delta;
+      if (!lr_varint_read (&data, end, &delta) || delta > (guint32)G_MAXINT - word)
+        return FALSE;
+
+      word += delta;
+
+      int index = word;
+      g_array_append_val (words, index);
+    }
+
+  return TRUE;
+}
+
+GArray *
+lr_word_list_parse_legacy (const gchar *string)
+{
+  GArray *words = g_array_new (FALSE, FALSE, sizeof (int));
+
+  gchar **indices = g_strsplit (string, ";", -1);
+  for (int i = 0; indices[i] != NULL; ++i)
+    {
+      if (*indices[i] == '\0')
+        continue;
+
+      gchar *end;
+      gint64 word = g_ascii_strtoll (indices[i], &end, 10);
+      if (end == indices[i] || *end != '\0' || word < 0 || word > G_MAXINT)
+        {
+          g_warning ("Skipping the corrupt word index '%s'", indices[i]);
+          continue;
+        }
+
+      int index = word;
+      g_array_append_val (words, index);
+    }
+  g_strfreev (indices);
+
+  return words;
+}
@@ -0,0 +1,48 @@
+/* 
+ * Langrise, expanding L2 vocabulary in context.
+ * Copyright (C) 2019 Iason Barmparesos
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _lr_word_list_h
+#define _lr_word_list_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * The encoding of the word indices of an instance, as stored in the Words
+ * column of the Instances table: the indices in ascending order, each one
+ * stored as a varint of its difference from the previous one (the first
+ * one from zero). The words of an instance are usually close together, so
+ * most of them take a single byte.
+ */
+
+/* Encodes the word indices (ints), which don't have to be sorted.
+ * Negative indices are dropped with a warning. */
+GBytes *lr_word_list_encode (GArray *words);
+
+/* Appends the decoded word indices to words, an array of ints, without
+ * allocating anything else. Returns FALSE if the data is corrupt. */
+gboolean lr_word_list_decode (const guint8 *data, gsize size, GArray *words);
+
+/* Parses the semicolon separated indices older databases stored,
+ * skipping (with a warning) any which aren't non-negative integers */
+GArray *lr_word_list_parse_legacy (const gchar *string);
+
+G_END_DECLS
+
+#endif /* _lr_word_list_h */